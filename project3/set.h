@@ -13,6 +13,10 @@
 
 typedef struct set SET;
 
+typedef struct cursor {
+    int index;			/* next slot to visit */
+} CURSOR;
+
 SET *createSet(int maxElts);
 
 void destroySet(SET *sp);
@@ -27,4 +31,16 @@ char *findElement(SET *sp, char *elt);
 
 char **getElements(SET *sp);
 
+void beginElements(SET *sp, CURSOR *cp);
+
+char *nextElement(SET *sp, CURSOR *cp);
+
+void forEachElement(SET *sp, void (*visit)(), void *arg);
+
+SET *setUnion(SET *sp1, SET *sp2);
+
+SET *setIntersect(SET *sp1, SET *sp2);
+
+SET *setDifference(SET *sp1, SET *sp2);
+
 # endif /* SET_H */
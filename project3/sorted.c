@@ -4,13 +4,25 @@
 #include "set.h"
 #include <stdbool.h>
 
+#define CHUNK_SIZE 65536
+
+struct chunk
+{
+	struct chunk *next;
+	int size;
+	int used;
+	char data[];
+};
+
 struct set
 {
 	char **data;
 	int length;
 	int count;
+	struct chunk *chunks;
 };
 
+static char *intern(SET *sp, char *elt);
 static int search(SET *sp, char *elt, bool *found);
 
 // Creates and allocates memory to the set that holds the pointer to the array of pointers that point to the strings, the current number of elements in the array, and the max number of elements in the array
@@ -21,20 +33,23 @@ SET *createSet(int maxElts)
 	assert(sp!=NULL);
 	sp->count=0;
 	sp->length=maxElts;
+	sp->chunks=NULL;
 	sp->data = malloc(sizeof(char*)*maxElts);
 	assert(sp->data!=NULL);
 	return sp;
 }
 
-// Frees up the memory allocated to the set in a backwards fashion, starting from each string and ending at pointer sp;
+// Frees up the memory allocated to the set in a backwards fashion, starting from the chunks that hold the strings and ending at pointer sp;
 // O(n)
 void destroySet(SET *sp) 
 {
 	assert(sp!=NULL);
-	int i;
-	for(i=0;i<sp->count;i++) 
+	struct chunk *cp;
+	while(sp->chunks!=NULL)
 	{
-		free(sp->data[i]); 
+		cp=sp->chunks;
+		sp->chunks=cp->next;
+		free(cp);
 	}
 	free(sp->data);
 	free(sp); 
@@ -62,12 +77,12 @@ void addElement(SET *sp, char *elt)
 		{
 			sp->data[i]=sp->data[i-1];
 		}
-		sp->data[idx]=strdup(elt);
+		sp->data[idx]=intern(sp, elt);
 		sp->count++;
 	}	
 }
 
-// Removes the element from the array pointed to by char **data assuming that the element is in said array, while also updating the count of elements in the array; First, it frees the memory for the deleted element; Then, it shifts the elements upward
+// Removes the element from the array pointed to by char **data assuming that the element is in said array, while also updating the count of elements in the array; It shifts the elements upward, while the copy of the string stays in its chunk until the set is destroyed
 // O(n) 
 void removeElement(SET *sp, char *elt)
 {
@@ -77,7 +92,6 @@ void removeElement(SET *sp, char *elt)
 	idx=search(sp, elt, &found);
 	if(found==true)
 	{
-		free(sp->data[idx]);
 		for(i=idx+1; i<sp->count; i++)
 		{
 			sp->data[i-1]=sp->data[i];
@@ -107,13 +121,115 @@ char **getElements(SET *sp)
 	assert(sp!=NULL);
 	int i;
 	char **temp=malloc(sizeof(char*)*sp->count);
+	assert(temp!=NULL);
 	for(i=0; i<sp->count; i++)
 	{
-		strcpy(temp[i],sp->data[i]);
+		temp[i]=sp->data[i];
 	}
 	return temp;
 }
 
+// Starts a traversal of the set with the cursor pointed to by cp, which the caller allocates; Together with nextElement, it visits the elements in place, so nothing is allocated or copied
+// O(1)
+void beginElements(SET *sp, CURSOR *cp)
+{
+	assert(sp!=NULL && cp!=NULL);
+	cp->index=0;
+}
+
+// Returns the next element of the traversal with the cursor pointed to by cp, or NULL once every element has been visited; The elements are visited in sorted order, and the set must not be changed during the traversal
+// O(1)
+char *nextElement(SET *sp, CURSOR *cp)
+{
+	assert(sp!=NULL && cp!=NULL);
+	if(cp->index>=sp->count)
+		return NULL;
+	return sp->data[cp->index++];
+}
+
+// Calls (*visit)(elt, arg) on each element of the set in the order of nextElement, so that the caller can stream the elements without an array of them
+// O(n)
+void forEachElement(SET *sp, void (*visit)(), void *arg)
+{
+	assert(sp!=NULL && visit!=NULL);
+	int i;
+	for(i=0;i<sp->count;i++)
+		(*visit)(sp->data[i], arg);
+}
+
+// Returns a new set that holds the elements that are in either set, found with a single merge of their sorted arrays: whichever of the two next elements is smaller is copied next, and an element in both sets is copied once, so the new array comes out sorted without a search or a shift
+// O(n+m)
+SET *setUnion(SET *sp1, SET *sp2)
+{
+	assert(sp1!=NULL && sp2!=NULL);
+	int i=0, j=0, cmp;
+	SET *sp=createSet(sp1->count+sp2->count+1);
+	while(i<sp1->count || j<sp2->count)
+	{
+		if(i==sp1->count)
+			cmp=1;
+		else if(j==sp2->count)
+			cmp=-1;
+		else
+			cmp=strcmp(sp1->data[i], sp2->data[j]);
+		if(cmp<=0)
+		{
+			sp->data[sp->count++]=intern(sp, sp1->data[i++]);
+			if(cmp==0)
+				j++;
+		}
+		else
+			sp->data[sp->count++]=intern(sp, sp2->data[j++]);
+	}
+	return sp;
+}
+
+// Returns a new set that holds the elements that are in both sets, found with a single merge of their sorted arrays in which only the elements that turn up in both are copied
+// O(n+m)
+SET *setIntersect(SET *sp1, SET *sp2)
+{
+	assert(sp1!=NULL && sp2!=NULL);
+	int i=0, j=0, cmp;
+	SET *sp=createSet(sp1->count<sp2->count ? sp1->count+1 : sp2->count+1);
+	while(i<sp1->count && j<sp2->count)
+	{
+		cmp=strcmp(sp1->data[i], sp2->data[j]);
+		if(cmp==0)
+		{
+			sp->data[sp->count++]=intern(sp, sp1->data[i]);
+			i++;
+			j++;
+		}
+		else if(cmp<0)
+			i++;
+		else
+			j++;
+	}
+	return sp;
+}
+
+// Returns a new set that holds the elements of the first set that are not in the second, found with a single merge of their sorted arrays in which the elements of the first set that have no match are copied; This takes the place of removing the elements of the second set one at a time, each of which would shift the rest of the array
+// O(n+m)
+SET *setDifference(SET *sp1, SET *sp2)
+{
+	assert(sp1!=NULL && sp2!=NULL);
+	int i=0, j=0, cmp;
+	SET *sp=createSet(sp1->count+1);
+	while(i<sp1->count)
+	{
+		cmp=j<sp2->count ? strcmp(sp1->data[i], sp2->data[j]) : -1;
+		if(cmp<0)
+			sp->data[sp->count++]=intern(sp, sp1->data[i++]);
+		else
+		{
+			if(cmp==0)
+				i++;
+			j++;
+		}
+	}
+	return sp;
+}
+
 // Private search function that finds the element pointed to by char *elt through binary search; For every execution of the 'while' loop, it halves the interval that the search function is parsing over until the desired element is found or the slot in the array for insertion or deletion is found; If the element is found, it returns the location of the element and changes the bool to true; If the element is not found, it returns the location where an insertion/deletion should occur and changes the bool to false
 // O(log n)
 static int search(SET *sp, char *elt, bool *found)
@@ -144,3 +260,33 @@ static int search(SET *sp, char *elt, bool *found)
 	return lo;
 }
 
+// Copies the string elt into the chunk at the head of the list of chunks and returns the copy; A new chunk is allocated when the string does not fit in the space left, so that the strings are packed together without the overhead of a separate allocation each, and the whole list is freed at once by destroySet. A string longer than a chunk gets a chunk of its own, which is linked behind the head so the space left in the head is not wasted
+// O(n)
+static char *intern(SET *sp, char *elt)
+{
+	int length=strlen(elt)+1;
+	struct chunk *cp=sp->chunks;
+	char *copy;
+	if(cp==NULL || cp->size-cp->used<length)
+	{
+		int size=length>CHUNK_SIZE ? length : CHUNK_SIZE;
+		cp=malloc(sizeof(struct chunk)+size);
+		assert(cp!=NULL);
+		cp->size=size;
+		cp->used=0;
+		if(size>CHUNK_SIZE && sp->chunks!=NULL)
+		{
+			cp->next=sp->chunks->next;
+			sp->chunks->next=cp;
+		}
+		else
+		{
+			cp->next=sp->chunks;
+			sp->chunks=cp;
+		}
+	}
+	copy=cp->data+cp->used;
+	memcpy(copy, elt, length);
+	cp->used+=length;
+	return copy;
+}
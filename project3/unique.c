@@ -19,6 +19,7 @@
 # include <string.h>
 # include <stdbool.h>
 # include "set.h"
+# include "words.h"
 
 
 /* This is sufficient for the test cases in /scratch/coen12. */
@@ -26,6 +27,18 @@
 # define MAX_SIZE 18000
 
 
+/*
+ * Function:    printElement
+ *
+ * Description: Print an element of the set on a line of its own.
+ */
+
+static void printElement(char *elt, FILE *fp)
+{
+    fprintf(fp, "%s\n", elt);
+}
+
+
 /*
  * Function:    main
  *
@@ -34,10 +47,10 @@
 
 int main(int argc, char *argv[])
 {
-    FILE *fp;
-    char buffer[BUFSIZ], **elts;
+    WORDS *wp;
+    char *word;
     SET *unique;
-    int i, words;
+    int i, words, length;
     bool lflag = false;
 
 
@@ -56,7 +69,7 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
-    if ((fp = fopen(argv[1], "r")) == NULL) {
+    if ((wp = openWords(argv[1])) == NULL) {
         fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
         exit(EXIT_FAILURE);
     }
@@ -67,12 +80,12 @@ int main(int argc, char *argv[])
     words = 0;
     unique = createSet(MAX_SIZE);
 
-    while (fscanf(fp, "%s", buffer) == 1) {
+    while ((word = nextWord(wp, &length)) != NULL) {
         words ++;
-        addElement(unique, buffer);
+        addElement(unique, termWord(wp, word, length));
     }
 
-    fclose(fp);
+    closeWords(wp);
 
     if (!lflag) {
 	printf("%d total words\n", words);
@@ -83,7 +96,7 @@ int main(int argc, char *argv[])
     /* Try to open the second file. */
 
     if (argc == 3) {
-        if ((fp = fopen(argv[2], "r")) == NULL) {
+        if ((wp = openWords(argv[2])) == NULL) {
             fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[2]);
             exit(EXIT_FAILURE);
         }
@@ -91,26 +104,20 @@ int main(int argc, char *argv[])
 
         /* Delete all words in the second file. */
 
-        while (fscanf(fp, "%s", buffer) == 1)
-            removeElement(unique, buffer);
+        while ((word = nextWord(wp, &length)) != NULL)
+            removeElement(unique, termWord(wp, word, length));
 
-	fclose(fp);
+	closeWords(wp);
 
 	if (!lflag)
 	    printf("%d remaining words\n", numElements(unique));
     }
 
 
-    /* Print the list of words if desired. */
-
-    if (lflag) {
-	elts = getElements(unique);
+    /* Print the list of words straight from the set if desired. */
 
-	for (i = 0; i < numElements(unique); i ++)
-	    printf("%s\n", elts[i]);
-
-	free(elts);
-    }
+    if (lflag)
+	forEachElement(unique, printElement, stdout);
 
     destroySet(unique);
     exit(EXIT_SUCCESS);
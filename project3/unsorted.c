@@ -3,13 +3,25 @@
 #include <string.h>
 #include "set.h"
 
+#define CHUNK_SIZE 65536
+
+struct chunk
+{
+	struct chunk *next;
+	int size;
+	int used;
+	char data[];
+};
+
 struct set
 {
 	char **data;
 	int length;
 	int count;
+	struct chunk *chunks;
 };
 
+static char *intern(SET *sp, char *elt);
 static int search(SET *sp, char *elt);
 
 // Creates and allocates memory to the set that holds the pointer to the array of pointers that point to the strings, the current number of elements in the array, and the max number of elements in the array
@@ -20,20 +32,23 @@ SET *createSet(int maxElts)
 	assert(sp!=NULL);
 	sp->count=0;
 	sp->length=maxElts;
+	sp->chunks=NULL;
 	sp->data = malloc(sizeof(char*)*maxElts);
 	assert(sp->data!=NULL);
 	return sp;
 }
 
-// Frees up the memory allocated to the set in a backwards fashion, starting from each string and ending at pointer sp;
+// Frees up the memory allocated to the set in a backwards fashion, starting from the chunks that hold the strings and ending at pointer sp;
 // O(n)
 void destroySet(SET *sp) 
 {
 	assert(sp!=NULL);
-	int i;
-	for(i=0;i<sp->count;i++) 
+	struct chunk *cp;
+	while(sp->chunks!=NULL)
 	{
-		free(sp->data[i]); 
+		cp=sp->chunks;
+		sp->chunks=cp->next;
+		free(cp);
 	}
 	free(sp->data);
 	free(sp); 
@@ -55,7 +70,7 @@ void addElement(SET *sp, char *elt)
 	if(search(sp,elt)==-1)
 	{
 		assert(sp->count<sp->length);		
-		sp->data[sp->count]=strdup(elt);
+		sp->data[sp->count]=intern(sp, elt);
 		assert(sp->data[sp->count]!=NULL);
 		sp->count++;
 	}	
@@ -70,7 +85,6 @@ void removeElement(SET *sp, char *elt)
 	i=search(sp, elt);
 	if (i==-1) 
 		return;
-	free(sp->data[i]);
 	sp->data[i]=sp->data[sp->count-1];
 	sp->count--;
 }
@@ -89,19 +103,91 @@ char *findElement(SET *sp, char *elt)
 }
 
 // Allocates memory to a new array that holds the data from sp->data to be returned to the interface and returns said array to the interface
-// O(1)
+// O(n)
 char **getElements(SET *sp)
 {
 	assert(sp!=NULL);
 	int i;
 	char **temp=malloc(sizeof(char*)*sp->count);
+	assert(temp!=NULL);
 	for(i=0;i<sp->count;i++)
 	{
-		strcpy(temp[i],sp->data[i]);
+		temp[i]=sp->data[i];
 	}
 	return temp;
 }
 
+// Starts a traversal of the set with the cursor pointed to by cp, which the caller allocates; Together with nextElement, it visits the elements in place, so nothing is allocated or copied
+// O(1)
+void beginElements(SET *sp, CURSOR *cp)
+{
+	assert(sp!=NULL && cp!=NULL);
+	cp->index=0;
+}
+
+// Returns the next element of the traversal with the cursor pointed to by cp, or NULL once every element has been visited; The elements are visited in the order of the array, and the set must not be changed during the traversal
+// O(1)
+char *nextElement(SET *sp, CURSOR *cp)
+{
+	assert(sp!=NULL && cp!=NULL);
+	if(cp->index>=sp->count)
+		return NULL;
+	return sp->data[cp->index++];
+}
+
+// Calls (*visit)(elt, arg) on each element of the set in the order of nextElement, so that the caller can stream the elements without an array of them
+// O(n)
+void forEachElement(SET *sp, void (*visit)(), void *arg)
+{
+	assert(sp!=NULL && visit!=NULL);
+	int i;
+	for(i=0;i<sp->count;i++)
+		(*visit)(sp->data[i], arg);
+}
+
+// Returns a new set that holds the elements that are in either set; The elements of the first set are copied as they are, since they are known to be distinct, and each element of the second set is only copied if a search of the first set does not find it
+// O(nm)
+SET *setUnion(SET *sp1, SET *sp2)
+{
+	assert(sp1!=NULL && sp2!=NULL);
+	int i;
+	SET *sp=createSet(sp1->count+sp2->count+1);
+	for(i=0;i<sp1->count;i++)
+		sp->data[sp->count++]=intern(sp, sp1->data[i]);
+	for(i=0;i<sp2->count;i++)
+		if(search(sp1, sp2->data[i])==-1)
+			sp->data[sp->count++]=intern(sp, sp2->data[i]);
+	return sp;
+}
+
+// Returns a new set that holds the elements that are in both sets, by searching the larger set for each element of the smaller one
+// O(nm)
+SET *setIntersect(SET *sp1, SET *sp2)
+{
+	assert(sp1!=NULL && sp2!=NULL);
+	int i;
+	SET *small=sp1->count<sp2->count ? sp1 : sp2;
+	SET *large=small==sp1 ? sp2 : sp1;
+	SET *sp=createSet(small->count+1);
+	for(i=0;i<small->count;i++)
+		if(search(large, small->data[i])!=-1)
+			sp->data[sp->count++]=intern(sp, small->data[i]);
+	return sp;
+}
+
+// Returns a new set that holds the elements of the first set that are not in the second, by searching the second set for each element of the first
+// O(nm)
+SET *setDifference(SET *sp1, SET *sp2)
+{
+	assert(sp1!=NULL && sp2!=NULL);
+	int i;
+	SET *sp=createSet(sp1->count+1);
+	for(i=0;i<sp1->count;i++)
+		if(search(sp2, sp1->data[i])==-1)
+			sp->data[sp->count++]=intern(sp, sp1->data[i]);
+	return sp;
+}
+
 // Private search function that finds the element pointed to by char *elt and returns the index of the element if found. Else, it returns -1 to indicate that the element was not found
 // O(n)
 static int search(SET *sp, char *elt)
@@ -115,3 +201,34 @@ static int search(SET *sp, char *elt)
 	}
 	return -1;
 }
+
+// Copies the string elt into the chunk at the head of the list of chunks and returns the copy; A new chunk is allocated when the string does not fit in the space left, so that the strings are packed together without the overhead of a separate allocation each, and the whole list is freed at once by destroySet. A string longer than a chunk gets a chunk of its own, which is linked behind the head so the space left in the head is not wasted
+// O(n)
+static char *intern(SET *sp, char *elt)
+{
+	int length=strlen(elt)+1;
+	struct chunk *cp=sp->chunks;
+	char *copy;
+	if(cp==NULL || cp->size-cp->used<length)
+	{
+		int size=length>CHUNK_SIZE ? length : CHUNK_SIZE;
+		cp=malloc(sizeof(struct chunk)+size);
+		assert(cp!=NULL);
+		cp->size=size;
+		cp->used=0;
+		if(size>CHUNK_SIZE && sp->chunks!=NULL)
+		{
+			cp->next=sp->chunks->next;
+			sp->chunks->next=cp;
+		}
+		else
+		{
+			cp->next=sp->chunks;
+			sp->chunks=cp;
+		}
+	}
+	copy=cp->data+cp->used;
+	memcpy(copy, elt, length);
+	cp->used+=length;
+	return copy;
+}
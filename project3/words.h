@@ -0,0 +1,30 @@
+/*
+ * File:        words.h
+ *
+ * Description: This file contains the public function and type
+ *              declarations for a tokenizer that splits a file into words
+ *              separated by white space, as fscanf("%s") does.  The file
+ *              is mapped read-only into memory and each word is returned
+ *              as a pointer into the mapping and a length, so no word is
+ *              copied unless the caller asks for a null-terminated copy:
+ *              termWord returns one that lasts until its next call, and
+ *              keepWord one that lasts as long as the tokenizer.  The
+ *              words stay valid until the tokenizer is closed.
+ */
+
+# ifndef WORDS_H
+# define WORDS_H
+
+typedef struct words WORDS;
+
+WORDS *openWords(char *path);
+
+void closeWords(WORDS *wp);
+
+char *nextWord(WORDS *wp, int *length);
+
+char *termWord(WORDS *wp, char *word, int length);
+
+char *keepWord(WORDS *wp, char *word, int length);
+
+# endif /* WORDS_H */
@@ -0,0 +1,242 @@
+/*
+ * File:        algebench.c
+ *
+ * Description: This file contains a benchmark for the union,
+ *              intersection, and difference of two sets, as given by
+ *              setUnion, setIntersect, and setDifference, compared with
+ *              the loops of single-element calls that they replace.
+ *
+ *              The program takes two files as command line arguments, as
+ *              unique does, and the words of each are inserted into a set
+ *              of their own.  The difference is compared with removing
+ *              every word of the second file from a copy of the first set,
+ *              as unique does.  The intersection is compared with looking
+ *              up each element of the first set in the second and adding
+ *              those found to a new set, and the union with copying the
+ *              first set and adding each element of the second.  Each is
+ *              timed ROUNDS times, and the time per round and the speedup
+ *              of the set operation are printed.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <time.h>
+# include <assert.h>
+# include "set.h"
+# include "words.h"
+
+
+# define ROUNDS 5
+
+
+/*
+ * Function:    now
+ *
+ * Description: Return the current time in nanoseconds.
+ */
+
+static long long now(void)
+{
+    struct timespec ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+/*
+ * Function:    copySet
+ *
+ * Description: Return a new set with the elements of a set, added to it
+ *              one batch at a time.
+ */
+
+static SET *copySet(SET *sp)
+{
+    SET *copy;
+    void **elts;
+
+
+    elts = getElements(sp);
+    copy = createSet(numElements(sp), strcmp, hashString);
+    addElements(copy, elts, numElements(sp));
+    free(elts);
+    return copy;
+}
+
+
+/*
+ * Function:    report
+ *
+ * Description: Print the time per round of the loop and of the set
+ *              operation for one kind of operation, and check that both
+ *              left the same number of elements.
+ */
+
+static void report(char *name, long long loop, long long op, int n, int m)
+{
+    assert(n == m);
+    printf("%-16s %10d %10.3f %10.3f %10.2f\n", name, n,
+	   (double) loop / ROUNDS / 1e6, (double) op / ROUNDS / 1e6,
+	   (double) loop / op);
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    WORDS *wp1, *wp2;
+    SET *sp1, *sp2, *sp, *copy;
+    char *word, **removed, **slot;
+    void **elts;
+    long long start, loop, op;
+    int i, k, m, n, nloop, nop, length;
+
+
+    /* Check usage and insert the words of each file into a set. */
+
+    if (argc != 3) {
+	fprintf(stderr, "usage: %s file1 file2\n", argv[0]);
+	exit(EXIT_FAILURE);
+    }
+
+    if ((wp1 = openWords(argv[1])) == NULL) {
+	fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
+	exit(EXIT_FAILURE);
+    }
+
+    if ((wp2 = openWords(argv[2])) == NULL) {
+	fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[2]);
+	exit(EXIT_FAILURE);
+    }
+
+    sp1 = createSet(0, strcmp, hashString);
+    sp2 = createSet(0, strcmp, hashString);
+
+    while ((word = nextWord(wp1, &length)) != NULL) {
+	word = termWord(wp1, word, length);
+	slot = (char **) findOrAddElement(sp1, word);
+
+	if (*slot == word)
+	    *slot = keepWord(wp1, word, length);
+    }
+
+    m = 0;
+    removed = NULL;
+
+    while ((word = nextWord(wp2, &length)) != NULL) {
+	word = keepWord(wp2, word, length);
+
+	if ((m & (m - 1)) == 0) {
+	    removed = realloc(removed, sizeof(char *) * (m == 0 ? 1 : m * 2));
+	    assert(removed != NULL);
+	}
+
+	removed[m ++] = word;
+	addElement(sp2, word);
+    }
+
+    printf("%d and %d distinct words, %d words in file2\n",
+	   numElements(sp1), numElements(sp2), m);
+    printf("%-16s %10s %10s %10s %10s\n", "ms/round", "elements", "loop",
+	   "set op", "speedup");
+
+
+    /* Time the difference against removing the words of the second file
+       from a copy of the first set, which is made outside of the timing. */
+
+    loop = op = 0;
+
+    for (k = 0; k < ROUNDS; k ++) {
+	copy = copySet(sp1);
+	start = now();
+
+	for (i = 0; i < m; i ++)
+	    removeElement(copy, removed[i]);
+
+	loop += now() - start;
+	nloop = numElements(copy);
+	destroySet(copy);
+
+	start = now();
+	sp = setDifference(sp1, sp2);
+	op += now() - start;
+	nop = numElements(sp);
+	destroySet(sp);
+    }
+
+    report("difference", loop, op, nloop, nop);
+
+
+    /* Time the intersection against looking up each element of the first
+       set in the second. */
+
+    loop = op = 0;
+    elts = getElements(sp1);
+    n = numElements(sp1);
+
+    for (k = 0; k < ROUNDS; k ++) {
+	start = now();
+	copy = createSet(0, strcmp, hashString);
+
+	for (i = 0; i < n; i ++)
+	    if (findElement(sp2, elts[i]) != NULL)
+		addElement(copy, elts[i]);
+
+	loop += now() - start;
+	nloop = numElements(copy);
+	destroySet(copy);
+
+	start = now();
+	sp = setIntersect(sp1, sp2);
+	op += now() - start;
+	nop = numElements(sp);
+	destroySet(sp);
+    }
+
+    free(elts);
+    report("intersection", loop, op, nloop, nop);
+
+
+    /* Time the union against copying the first set and adding each
+       element of the second. */
+
+    loop = op = 0;
+    elts = getElements(sp2);
+    n = numElements(sp2);
+
+    for (k = 0; k < ROUNDS; k ++) {
+	start = now();
+	copy = copySet(sp1);
+
+	for (i = 0; i < n; i ++)
+	    addElement(copy, elts[i]);
+
+	loop += now() - start;
+	nloop = numElements(copy);
+	destroySet(copy);
+
+	start = now();
+	sp = setUnion(sp1, sp2);
+	op += now() - start;
+	nop = numElements(sp);
+	destroySet(sp);
+    }
+
+    free(elts);
+    report("union", loop, op, nloop, nop);
+
+    free(removed);
+    destroySet(sp1);
+    destroySet(sp2);
+    closeWords(wp1);
+    closeWords(wp2);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,148 @@
+/*
+ * File:        batchbench.c
+ *
+ * Description: This file contains a benchmark for looking up elements of
+ *              a set in batches.
+ *
+ *              The program takes a file as a command line argument.  The
+ *              distinct words of the file are inserted into a set with
+ *              addElements, and are then looked up in a random order, first
+ *              one at a time with findElement and then with findElements
+ *              for batch sizes from 1 up to 64.  Every lookup must find its
+ *              word.  The throughput of each run is printed.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <time.h>
+# include <assert.h>
+# include "set.h"
+# include "words.h"
+
+
+# define ROUNDS 10
+# define MAX_BATCH 64
+
+
+/*
+ * Function:    now
+ *
+ * Description: Return the current time in nanoseconds.
+ */
+
+static long long now(void)
+{
+    struct timespec ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    WORDS *wp;
+    SET *sp;
+    char *word, **words, *tmp;
+    void *results[MAX_BATCH];
+    int i, j, k, n, size, batch, length;
+    long long start, elapsed;
+
+
+    /* Check usage and read the words of the file. */
+
+    if (argc != 2) {
+	fprintf(stderr, "usage: %s file\n", argv[0]);
+	exit(EXIT_FAILURE);
+    }
+
+    if ((wp = openWords(argv[1])) == NULL) {
+	fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
+	exit(EXIT_FAILURE);
+    }
+
+    n = 0;
+    size = 1024;
+    words = malloc(sizeof(char *) * size);
+    assert(words != NULL);
+
+    while ((word = nextWord(wp, &length)) != NULL) {
+	word = keepWord(wp, word, length);
+
+	if (n == size) {
+	    size *= 2;
+	    words = realloc(words, sizeof(char *) * size);
+	    assert(words != NULL);
+	}
+
+	words[n ++] = word;
+    }
+
+
+    /* Insert the words, keep only the distinct ones, and shuffle them so
+       that consecutive lookups touch unrelated slots. */
+
+    sp = createSet(0, strcmp, hashString);
+    addElements(sp, (void **) words, n);
+    free(words);
+
+    n = numElements(sp);
+    words = getElements(sp);
+    srand(1);
+
+    for (i = n - 1; i > 0; i --) {
+	j = rand() % (i + 1);
+	tmp = words[i];
+	words[i] = words[j];
+	words[j] = tmp;
+    }
+
+    printf("%d distinct words, %d lookups per run\n", n, n * ROUNDS);
+    printf("%8s %10s %14s\n", "batch", "time (s)", "lookups/s");
+
+
+    /* Look up every word one at a time. */
+
+    start = now();
+
+    for (k = 0; k < ROUNDS; k ++)
+	for (i = 0; i < n; i ++)
+	    assert(findElement(sp, words[i]) == words[i]);
+
+    elapsed = now() - start;
+    printf("%8s %10.3f %14.0f\n", "single", elapsed / 1e9,
+	   (double) n * ROUNDS / (elapsed / 1e9));
+
+
+    /* Look up every word in batches of each size. */
+
+    for (batch = 1; batch <= MAX_BATCH; batch *= 2) {
+	start = now();
+
+	for (k = 0; k < ROUNDS; k ++)
+	    for (i = 0; i < n; i += batch) {
+		size = n - i < batch ? n - i : batch;
+		findElements(sp, (void **) words + i, size, results);
+
+		for (j = 0; j < size; j ++)
+		    assert(results[j] == words[i + j]);
+	    }
+
+	elapsed = now() - start;
+	printf("%8d %10.3f %14.0f\n", batch, elapsed / 1e9,
+	       (double) n * ROUNDS / (elapsed / 1e9));
+    }
+
+    free(words);
+    destroySet(sp);
+    closeWords(wp);
+    exit(EXIT_SUCCESS);
+}
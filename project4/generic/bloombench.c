@@ -0,0 +1,240 @@
+/*
+ * File:        bloombench.c
+ *
+ * Description: This file contains a benchmark for the Bloom filter that
+ *              a set keeps in front of its table when it is created with
+ *              SET_BLOOM.
+ *
+ *              The program takes two files as command line arguments, as
+ *              unique does.  The words of the first file are inserted into
+ *              a set with and without the filter.  Both sets are then
+ *              timed looking up each distinct word of the first file, and
+ *              a copy of each with a character appended, which is not in
+ *              the set, in a random order.  Last, both are timed removing
+ *              every word of the second file, as unique does.  The time
+ *              per operation and the speedup of the filter are printed.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <time.h>
+# include <assert.h>
+# include "set.h"
+# include "words.h"
+
+
+# define ROUNDS 5
+
+
+/*
+ * Function:    now
+ *
+ * Description: Return the current time in nanoseconds.
+ */
+
+static long long now(void)
+{
+    struct timespec ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+/*
+ * Function:    report
+ *
+ * Description: Print the time per operation of the sets without and with
+ *              the filter for one kind of operation on N keys.
+ */
+
+static void report(char *name, long long plain, long long bloom, long n)
+{
+    printf("%-16s %10.1f %10.1f %10.2f\n", name, (double) plain / n,
+	   (double) bloom / n, (double) plain / bloom);
+}
+
+
+/*
+ * Function:    lookups
+ *
+ * Description: Return the time taken to look up each of the N keys of
+ *              KEYS in the set ROUNDS times, which must find them exactly
+ *              if FOUND is nonzero and must not find them otherwise.
+ */
+
+static long long lookups(SET *sp, char **keys, int n, int found)
+{
+    long long start = now();
+    int i, k;
+
+
+    for (k = 0; k < ROUNDS; k ++)
+	for (i = 0; i < n; i ++)
+	    assert((findElement(sp, keys[i]) != NULL) == found);
+
+    return now() - start;
+}
+
+
+/*
+ * Function:    removals
+ *
+ * Description: Return the time taken to remove the N words of WORDS from
+ *              the set, which must then hold LEFT elements.
+ */
+
+static long long removals(SET *sp, char **words, int n, int left)
+{
+    long long start = now();
+    int i;
+
+
+    for (i = 0; i < n; i ++)
+	removeElement(sp, words[i]);
+
+    start = now() - start;
+    assert(numElements(sp) == left);
+    return start;
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    WORDS *wp1, *wp2;
+    SET *plain, *bloom, *scratch;
+    char *word, **hits, **misses, **removed, **slot, *tmp;
+    long long times[3][2];
+    int i, j, n, m, length;
+
+
+    /* Check usage and insert the words of the first file. */
+
+    if (argc != 3) {
+	fprintf(stderr, "usage: %s file1 file2\n", argv[0]);
+	exit(EXIT_FAILURE);
+    }
+
+    if ((wp1 = openWords(argv[1])) == NULL) {
+	fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
+	exit(EXIT_FAILURE);
+    }
+
+    if ((wp2 = openWords(argv[2])) == NULL) {
+	fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[2]);
+	exit(EXIT_FAILURE);
+    }
+
+    plain = createSet(0, strcmp, hashString);
+    bloom = createSetWith(0, strcmp, hashString, SET_BLOOM);
+
+    while ((word = nextWord(wp1, &length)) != NULL) {
+	word = termWord(wp1, word, length);
+	slot = (char **) findOrAddElement(plain, word);
+
+	if (*slot == word)
+	    *slot = keepWord(wp1, word, length);
+
+	addElement(bloom, *slot);
+    }
+
+    assert(numElements(plain) == numElements(bloom));
+
+
+    /* Make a key that is not in the set for each word that is, and
+       shuffle both kinds of keys. */
+
+    n = numElements(plain);
+    hits = getElements(plain);
+    misses = malloc(sizeof(char *) * n);
+    assert(misses != NULL);
+
+    for (i = 0; i < n; i ++) {
+	length = strlen(hits[i]);
+	misses[i] = malloc(length + 2);
+	assert(misses[i] != NULL);
+
+	memcpy(misses[i], hits[i], length);
+	strcpy(misses[i] + length, "#");
+    }
+
+    srand(1);
+
+    for (i = n - 1; i > 0; i --) {
+	j = rand() % (i + 1);
+	tmp = hits[i];
+	hits[i] = hits[j];
+	hits[j] = tmp;
+
+	j = rand() % (i + 1);
+	tmp = misses[i];
+	misses[i] = misses[j];
+	misses[j] = tmp;
+    }
+
+
+    /* Collect the words of the second file and count how many of the
+       words of the first are left once they are removed, using a
+       scratch set so that neither of the timed sets is disturbed. */
+
+    m = 0;
+    removed = NULL;
+
+    while ((word = nextWord(wp2, &length)) != NULL) {
+	word = keepWord(wp2, word, length);
+
+	if ((m & (m - 1)) == 0) {
+	    removed = realloc(removed, sizeof(char *) * (m == 0 ? 1 : m * 2));
+	    assert(removed != NULL);
+	}
+
+	removed[m ++] = word;
+    }
+
+    scratch = createSet(n, strcmp, hashString);
+
+    for (i = 0; i < n; i ++)
+	addElement(scratch, hits[i]);
+
+    for (i = 0; i < m; i ++)
+	removeElement(scratch, removed[i]);
+
+    j = numElements(scratch);
+    destroySet(scratch);
+
+
+    /* Time both sets. */
+
+    times[0][0] = lookups(plain, hits, n, 1);
+    times[0][1] = lookups(bloom, hits, n, 1);
+    times[1][0] = lookups(plain, misses, n, 0);
+    times[1][1] = lookups(bloom, misses, n, 0);
+    times[2][0] = removals(plain, removed, m, j);
+    times[2][1] = removals(bloom, removed, m, j);
+
+    printf("%d distinct words, %d words removed\n", n, m);
+    printf("%-16s %10s %10s %10s\n", "ns/op", "plain", "bloom", "speedup");
+    report("lookup hit", times[0][0], times[0][1], (long) n * ROUNDS);
+    report("lookup miss", times[1][0], times[1][1], (long) n * ROUNDS);
+    report("remove file2", times[2][0], times[2][1], m);
+
+    for (i = 0; i < n; i ++)
+	free(misses[i]);
+
+    free(hits);
+    free(misses);
+    free(removed);
+    destroySet(plain);
+    destroySet(bloom);
+    closeWords(wp1);
+    closeWords(wp2);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,234 @@
+/*
+ * File:        cbench.c
+ *
+ * Description: This file contains a benchmark for the concurrent set
+ *              abstract data type.
+ *
+ *              The program takes a file and an optional maximum number of
+ *              threads as command line arguments.  The words of the file
+ *              are counted as in counts.c, once for each number of
+ *              threads from one up to the maximum.  Each thread counts
+ *              its own slice of the words into one shared concurrent set,
+ *              and the time and throughput of each run are printed.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <time.h>
+# include <assert.h>
+# include <pthread.h>
+# include "set.h"
+# include "cset.h"
+
+
+# define SHARDS 64
+# define DEFAULT_THREADS 8
+
+struct entry {
+    char *word;
+    int count;
+};
+
+struct slice {
+    CSET *counts;
+    char **words;
+    int n;
+};
+
+
+/*
+ * Function:	hashEntry
+ *
+ * Description:	Return a hash value for an entry based on its word.
+ */
+
+static unsigned hashEntry(struct entry *ep)
+{
+    return hashString(ep->word);
+}
+
+
+/*
+ * Function:	compareEntries
+ *
+ * Description:	Compare two entries as in strcmp().
+ */
+
+static int compareEntries(struct entry *ep1, struct entry *ep2)
+{
+    return strcmp(ep1->word, ep2->word);
+}
+
+
+/*
+ * Function:	createEntry
+ *
+ * Description:	Return a new entry with a count of zero for the word of
+ *		the temporary entry EP.
+ */
+
+static void *createEntry(struct entry *ep)
+{
+    struct entry *np;
+
+
+    np = malloc(sizeof(struct entry));
+    assert(np != NULL);
+
+    np->word = ep->word;
+    np->count = 0;
+    return np;
+}
+
+
+/*
+ * Function:	incrementEntry
+ *
+ * Description:	Increment the count of an entry.
+ */
+
+static void incrementEntry(struct entry *ep)
+{
+    ep->count ++;
+}
+
+
+/*
+ * Function:	countSlice
+ *
+ * Description:	Thread function that counts the words of one slice.
+ */
+
+static void *countSlice(void *arg)
+{
+    struct slice *sp = arg;
+    struct entry e;
+    int i;
+
+
+    for (i = 0; i < sp->n; i ++) {
+	e.word = sp->words[i];
+	updateCElement(sp->counts, &e, createEntry, incrementEntry);
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Function:    now
+ *
+ * Description: Return the current time in nanoseconds.
+ */
+
+static long long now(void)
+{
+    struct timespec ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    FILE *fp;
+    char buffer[BUFSIZ], **words;
+    int i, t, n, length, total, maxThreads;
+    struct slice *slices;
+    struct entry **entries;
+    pthread_t *threads;
+    long long start, elapsed;
+    CSET *counts;
+
+
+    /* Check usage and read the words. */
+
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "usage: %s file [threads]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if ((fp = fopen(argv[1], "r")) == NULL) {
+        fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
+        exit(EXIT_FAILURE);
+    }
+
+    maxThreads = argc == 3 ? atoi(argv[2]) : DEFAULT_THREADS;
+    assert(maxThreads > 0);
+
+    length = 1024;
+    words = malloc(sizeof(char *) * length);
+    assert(words != NULL);
+
+    for (n = 0; fscanf(fp, "%s", buffer) == 1; n ++) {
+	if (n == length) {
+	    length *= 2;
+	    words = realloc(words, sizeof(char *) * length);
+	    assert(words != NULL);
+	}
+
+	words[n] = strdup(buffer);
+	assert(words[n] != NULL);
+    }
+
+    fclose(fp);
+
+    threads = malloc(sizeof(pthread_t) * maxThreads);
+    slices = malloc(sizeof(struct slice) * maxThreads);
+    assert(threads != NULL && slices != NULL);
+
+    printf("%d words, %d shards\n", n, SHARDS);
+    printf("%8s %10s %12s\n", "threads", "time (s)", "Mwords/s");
+
+
+    /* Count the words with each number of threads. */
+
+    for (t = 1; t <= maxThreads; t ++) {
+	counts = createCSet(SHARDS, 0, compareEntries, hashEntry);
+	start = now();
+
+	for (i = 0; i < t; i ++) {
+	    slices[i].counts = counts;
+	    slices[i].words = words + (long) n * i / t;
+	    slices[i].n = (long) n * (i + 1) / t - (long) n * i / t;
+	    pthread_create(&threads[i], NULL, countSlice, &slices[i]);
+	}
+
+	for (i = 0; i < t; i ++)
+	    pthread_join(threads[i], NULL);
+
+	elapsed = now() - start;
+	printf("%8d %10.3f %12.2f\n", t, elapsed / 1e9, n / (elapsed / 1e3));
+
+
+	/* Check that every word was counted once. */
+
+	entries = getCElements(counts);
+
+	for (i = total = 0; i < numCElements(counts); i ++) {
+	    total += entries[i]->count;
+	    free(entries[i]);
+	}
+
+	assert(total == n);
+	free(entries);
+	destroyCSet(counts);
+    }
+
+    for (i = 0; i < n; i ++)
+	free(words[i]);
+
+    free(words);
+    free(slices);
+    free(threads);
+    exit(EXIT_SUCCESS);
+}
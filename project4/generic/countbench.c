@@ -0,0 +1,218 @@
+/*
+ * File:        countbench.c
+ *
+ * Description: This file contains a benchmark for counting words with
+ *              several threads.
+ *
+ *              The program takes a file and an optional maximum number of
+ *              threads as command line arguments.  The words of the file
+ *              are first counted serially with the tokenizer as in counts.c,
+ *              and
+ *              then with countWords for each number of threads from one up
+ *              to the maximum.  Each parallel count must give the same
+ *              entries in the same order as the serial count.  The time,
+ *              throughput, and speedup of each run are printed.
+ *
+ *              Before the benchmark, words much longer than BUFSIZ are
+ *              counted with several threads to check that they are
+ *              counted whole, as the serial tokenizer counts them.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <time.h>
+# include <assert.h>
+# include <sys/stat.h>
+# include "set.h"
+# include "wordcount.h"
+# include "words.h"
+
+
+# define MAX_SIZE 18000
+# define DEFAULT_THREADS 8
+# define LONG_WORD 10000
+
+
+/*
+ * Function:    now
+ *
+ * Description: Return the current time in nanoseconds.
+ */
+
+static long long now(void)
+{
+    struct timespec ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+/*
+ * Function:    destroyCounts
+ *
+ * Description: Free the entries of a set of counts and then the set.
+ */
+
+static void destroyCounts(SET *counts)
+{
+    struct entry **entries;
+    int i;
+
+
+    entries = getElements(counts);
+
+    for (i = 0; i < numElements(counts); i ++) {
+        free(entries[i]->word);
+        free(entries[i]);
+    }
+
+    free(entries);
+    destroySet(counts);
+}
+
+
+/*
+ * Function:    checkLongWords
+ *
+ * Description: Count a temporary file holding two copies of a word of
+ *              LONG_WORD characters among short words with one to four
+ *              threads, and check that each count has the long word
+ *              whole and twice.
+ */
+
+static void checkLongWords(void)
+{
+    FILE *fp;
+    struct entry e, *ep;
+    int i, t;
+    SET *counts;
+
+
+    fp = tmpfile();
+    assert(fp != NULL);
+    e.word = malloc(LONG_WORD + 1);
+    assert(e.word != NULL);
+
+    for (i = 0; i < LONG_WORD; i ++)
+        e.word[i] = 'a' + i % 26;
+
+    e.word[LONG_WORD] = '\0';
+    fprintf(fp, "one %s two\n%s three\n", e.word, e.word);
+    fflush(fp);
+
+    for (t = 1; t <= 4; t ++) {
+        counts = countWords(fileno(fp), t, 0);
+        assert(numElements(counts) == 4);
+        ep = findElement(counts, &e);
+        assert(ep != NULL && ep->count == 2);
+        destroyCounts(counts);
+    }
+
+    free(e.word);
+    fclose(fp);
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    FILE *fp;
+    WORDS *wp;
+    char *word;
+    struct entry e, *ep, **slot, **expected, **entries;
+    int i, t, n, maxThreads, length;
+    long long start, serial, elapsed;
+    struct stat st;
+    SET *counts;
+
+
+    /* Check usage and open the file. */
+
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "usage: %s file [threads]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if ((fp = fopen(argv[1], "r")) == NULL) {
+        fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
+        exit(EXIT_FAILURE);
+    }
+
+    maxThreads = argc == 3 ? atoi(argv[2]) : DEFAULT_THREADS;
+    assert(maxThreads > 0);
+    fstat(fileno(fp), &st);
+    checkLongWords();
+
+
+    /* Count the words serially as in counts.c. */
+
+    start = now();
+    wp = openWords(argv[1]);
+    assert(wp != NULL);
+    counts = createSet(MAX_SIZE, compareEntries, hashEntry);
+
+    while ((word = nextWord(wp, &length)) != NULL) {
+        e.word = termWord(wp, word, length);
+        slot = (struct entry **) findOrAddElement(counts, &e);
+
+        if (*slot == &e) {
+            ep = malloc(sizeof(struct entry));
+            assert(ep != NULL);
+
+            ep->word = keepWord(wp, word, length);
+            ep->count = 0;
+            *slot = ep;
+        }
+
+        (*slot)->count ++;
+    }
+
+    serial = now() - start;
+    n = numElements(counts);
+    expected = getElements(counts);
+    destroySet(counts);
+
+    printf("%ld bytes, %d distinct words\n", (long) st.st_size, n);
+    printf("%8s %10s %10s %10s\n", "threads", "time (s)", "MB/s", "speedup");
+    printf("%8s %10.3f %10.1f %10.2f\n", "serial", serial / 1e9,
+           st.st_size / (serial / 1e3), 1.0);
+
+
+    /* Count the words in parallel and compare with the serial count. */
+
+    for (t = 1; t <= maxThreads; t ++) {
+        start = now();
+        counts = countWords(fileno(fp), t, MAX_SIZE);
+        elapsed = now() - start;
+
+        assert(numElements(counts) == n);
+        entries = getElements(counts);
+
+        for (i = 0; i < n; i ++) {
+            assert(strcmp(entries[i]->word, expected[i]->word) == 0);
+            assert(entries[i]->count == expected[i]->count);
+        }
+
+        printf("%8d %10.3f %10.1f %10.2f\n", t, elapsed / 1e9,
+               st.st_size / (elapsed / 1e3), (double) serial / elapsed);
+
+        free(entries);
+        destroyCounts(counts);
+    }
+
+    for (i = 0; i < n; i ++)
+        free(expected[i]);
+
+    free(expected);
+    closeWords(wp);
+    fclose(fp);
+    exit(EXIT_SUCCESS);
+}
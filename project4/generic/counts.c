@@ -8,64 +8,355 @@
  *
  *              The program takes one file as a command line argument and
  *              counts the number of times each word appears in the file.
+ *              With the -j option, the file is split among the given
+ *              number of threads, and the output is identical to that of
+ *              the serial count.
+ *
+ *              With the -k option, only the given number of most frequent
+ *              words are printed, from the most frequent down, with ties
+ *              in alphabetical order.  They are picked from the full count
+ *              table with a bounded priority queue, so the table itself is
+ *              neither sorted nor printed.  The -s option prints the given
+ *              number of words in the same way, but counts them with the
+ *              Space-Saving algorithm, which only keeps that many
+ *              counters however many distinct words there are.  Its
+ *              counts may be too high, so each is followed by the most it
+ *              can be over.
+ *
+ *              With the -c option, the words are counted in a Count-Min
+ *              sketch of the given width instead of the count table, and
+ *              the -d option sets its depth.  The memory of the sketch is
+ *              fixed, and its counts may also be too high.  Since a sketch
+ *              cannot list its words, it is used together with -k, and the
+ *              words whose estimates are the largest so far are kept
+ *              aside as they are read.
  */
 
 # include <stdio.h>
 # include <stdlib.h>
 # include <string.h>
 # include <assert.h>
+# include <fcntl.h>
+# include <unistd.h>
+# include <stdbool.h>
 # include "set.h"
+# include "pqueue.h"
+# include "sketch.h"
+# include "wordcount.h"
+# include "words.h"
 
-struct entry {
-    char *word;
-    int count;
+
+/* This is only an initial size hint; the set grows as needed. */
+
+# define MAX_SIZE 18000
+
+
+/* The number of rows of a sketch unless -d is given. */
+
+# define DEPTH 4
+
+
+/* A counter of the Space-Saving algorithm.  The entry is first, so that a
+   pointer to it is also a pointer to the counter. */
+
+struct counter {
+    struct entry entry;		/* word and count */
+    int error;			/* most the count can be over */
+    int queued;			/* count when it was added to the queue */
 };
 
 
-/* This is sufficient for the test cases in /scratch/coen12. */
+/*
+ * Function:    printEntry
+ *
+ * Description: Print the word and count of an entry on a line of its own.
+ */
 
-# define MAX_SIZE 18000
+static void printEntry(struct entry *ep, FILE *fp)
+{
+    fprintf(fp, "%s: %d\n", ep->word, ep->count);
+}
 
 
 /*
- * Function:    strhash
+ * Function:    compareCounts
  *
- * Description: Return a hash value for a string S.
+ * Description: Compare two entries by their counts, and by their words
+ *              in reverse when their counts are equal, so that the entry
+ *              that is printed later in the top-K list is smaller.
  */
 
-static unsigned strhash(char *s)
+static int compareCounts(struct entry *ep1, struct entry *ep2)
 {
-    unsigned hash = 0;
+    if (ep1->count != ep2->count)
+	return ep1->count < ep2->count ? -1 : 1;
 
+    return strcmp(ep2->word, ep1->word);
+}
 
-    while (*s != '\0')
-        hash = 31 * hash + *s ++;
 
-    return hash;
+/*
+ * Function:    compareCounters
+ *
+ * Description: Compare two counters by the counts with which they were
+ *              added to the queue, breaking ties as in compareCounts.
+ */
+
+static int compareCounters(struct counter *cp1, struct counter *cp2)
+{
+    if (cp1->queued != cp2->queued)
+	return cp1->queued < cp2->queued ? -1 : 1;
+
+    return strcmp(cp2->entry.word, cp1->entry.word);
 }
 
 
 /*
- * Function:	hashEntry
+ * Function:    printTop
  *
- * Description:	Return a hash value for an entry based on its word.
+ * Description: Print the K entries of the set with the largest counts,
+ *              from the largest down.  The entries are passed through a
+ *              min-heap that holds at most K of them, so the smallest of
+ *              the K largest so far is always at its front and is replaced
+ *              by any entry larger than it.  At the end, the heap hands
+ *              the entries back from the smallest up.
  */
 
-static unsigned hashEntry(struct entry *ep)
+static void printTop(SET *sp, int k)
 {
-    return strhash(ep->word);
+    struct entry *ep, **top;
+    CURSOR cursor;
+    PQ *pq;
+    int i, n;
+
+
+    pq = createQueue(compareCounts);
+    beginElements(sp, &cursor);
+
+    while ((ep = nextElement(sp, &cursor)) != NULL)
+	if (numEntries(pq) < k)
+	    addEntry(pq, ep);
+	else if (compareCounts(ep, firstEntry(pq)) > 0) {
+	    removeEntry(pq);
+	    addEntry(pq, ep);
+	}
+
+    n = numEntries(pq);
+    top = malloc(sizeof(struct entry *) * n);
+    assert(top != NULL || n == 0);
+
+    for (i = n - 1; i >= 0; i --)
+	top[i] = removeEntry(pq);
+
+    for (i = 0; i < n; i ++)
+	printEntry(top[i], stdout);
+
+    free(top);
+    destroyQueue(pq);
+}
+
+
+/*
+ * Function:    smallestCounter
+ *
+ * Description: Return the counter with the smallest count in the queue,
+ *              leaving it at the front.  Counts only grow, and a counter is
+ *              not moved in the queue when its count does, so the count
+ *              with which a counter was queued is never more than its
+ *              count now.  A counter at the front whose count has grown is
+ *              queued again with its new count, and once the counter at
+ *              the front is current, no other counter can have a smaller
+ *              count.
+ */
+
+static struct counter *smallestCounter(PQ *pq)
+{
+    struct counter *cp;
+
+
+    cp = firstEntry(pq);
+
+    while (cp->queued != cp->entry.count) {
+	removeEntry(pq);
+	cp->queued = cp->entry.count;
+	addEntry(pq, cp);
+	cp = firstEntry(pq);
+    }
+
+    return cp;
 }
 
 
 /*
- * Function:	compareEntries
+ * Function:    removeSmallest
  *
- * Description:	Compare two entries as in strcmp().
+ * Description: Remove and return the counter with the smallest count from
+ *              the queue.
  */
 
-static int compareEntries(struct entry *ep1, struct entry *ep2)
+static struct counter *removeSmallest(PQ *pq)
 {
-    return strcmp(ep1->word, ep2->word);
+    smallestCounter(pq);
+    return removeEntry(pq);
+}
+
+
+/*
+ * Function:    printCounters
+ *
+ * Description: Remove the N counters from the queue from the smallest up
+ *              and print them from the largest down, along with their
+ *              errors if ERRORS is true.
+ */
+
+static void printCounters(PQ *pq, int n, bool errors)
+{
+    struct counter **top;
+    int i;
+
+
+    top = malloc(sizeof(struct counter *) * n);
+    assert(top != NULL || n == 0);
+
+    for (i = n - 1; i >= 0; i --)
+	top[i] = removeSmallest(pq);
+
+    for (i = 0; i < n; i ++)
+	if (errors)
+	    printf("%s: %d (error %d)\n", top[i]->entry.word,
+		   top[i]->entry.count, top[i]->error);
+	else
+	    printEntry(&top[i]->entry, stdout);
+
+    free(top);
+}
+
+
+/*
+ * Function:    spaceSaving
+ *
+ * Description: Count the words read from WP with K counters and print the
+ *              words of the counters from the largest count down.  A word
+ *              that has no counter takes a free one if there is one, or
+ *              else takes over the counter with the smallest count, whose
+ *              count it keeps as the error of its own.  Any word that
+ *              occurs more often than the smallest count ends up with a
+ *              counter.  The set maps the words to their counters and has
+ *              at most K elements.
+ */
+
+static void spaceSaving(WORDS *wp, int k)
+{
+    struct counter *counters, *cp;
+    struct entry e;
+    SET *monitored;
+    char *word;
+    PQ *pq;
+    int n, length;
+
+
+    counters = malloc(sizeof(struct counter) * k);
+    assert(counters != NULL);
+
+    monitored = createSet(k, compareEntries, hashEntry);
+    pq = createQueue(compareCounters);
+    n = 0;
+
+    while ((word = nextWord(wp, &length)) != NULL) {
+	e.word = termWord(wp, word, length);
+
+	if ((cp = findElement(monitored, &e)) != NULL) {
+	    cp->entry.count ++;
+	    continue;
+	}
+
+	if (n < k) {
+	    cp = &counters[n ++];
+	    cp->entry.count = 0;
+	    cp->error = 0;
+	} else {
+	    cp = removeSmallest(pq);
+	    removeElement(monitored, &cp->entry);
+	    cp->error = cp->entry.count;
+	}
+
+	cp->entry.word = keepWord(wp, word, length);
+	cp->entry.count ++;
+	cp->queued = cp->entry.count;
+	addElement(monitored, &cp->entry);
+	addEntry(pq, cp);
+    }
+
+
+    printCounters(pq, n, true);
+    free(counters);
+    destroyQueue(pq);
+    destroySet(monitored);
+}
+
+
+/*
+ * Function:    sketchTop
+ *
+ * Description: Count the words read from WP in a Count-Min sketch of the
+ *              given width and depth, and print the K words with the
+ *              largest estimates.  The words with the largest estimates so
+ *              far are kept in K counters, whose counts are their
+ *              estimates.  A word without a counter takes over the counter
+ *              with the smallest count once its own estimate is larger,
+ *              and since the sketch remembers every word, the estimate of
+ *              a word that lost its counter keeps growing all the same.
+ */
+
+static void sketchTop(WORDS *wp, int width, int depth, int k)
+{
+    struct counter *counters, *cp;
+    struct entry e;
+    SET *candidates;
+    SKETCH *sketch;
+    char *word;
+    PQ *pq;
+    int n, count, length;
+
+
+    counters = malloc(sizeof(struct counter) * k);
+    assert(counters != NULL);
+
+    sketch = createSketch(width, depth, hashString);
+    candidates = createSet(k, compareEntries, hashEntry);
+    pq = createQueue(compareCounters);
+    n = 0;
+
+    while ((word = nextWord(wp, &length)) != NULL) {
+	e.word = termWord(wp, word, length);
+	count = addToSketch(sketch, e.word);
+
+	if ((cp = findElement(candidates, &e)) != NULL) {
+	    cp->entry.count = count;
+	    continue;
+	}
+
+	if (n < k)
+	    cp = &counters[n ++];
+	else if (count > smallestCounter(pq)->entry.count) {
+	    cp = removeSmallest(pq);
+	    removeElement(candidates, &cp->entry);
+	} else
+	    continue;
+
+	cp->entry.word = keepWord(wp, word, length);
+	cp->entry.count = count;
+	cp->error = 0;
+	cp->queued = count;
+	addElement(candidates, &cp->entry);
+	addEntry(pq, cp);
+    }
+
+    printCounters(pq, n, false);
+    free(counters);
+    destroyQueue(pq);
+    destroySet(candidates);
+    destroySketch(sketch);
 }
 
 
@@ -77,61 +368,135 @@ static int compareEntries(struct entry *ep1, struct entry *ep2)
 
 int main(int argc, char *argv[])
 {
-    FILE *fp;
-    char buffer[BUFSIZ];
-    struct entry e, *ep, **entries;
+    WORDS *wp;
+    char *word;
+    struct entry e, *ep, **slot;
+    CURSOR cursor;
     SET *counts;
-    int i;
+    int i, fd, threads, top, width, depth, length;
+    bool saving;
 
 
     /* Check usage and open the file. */
 
-    if (argc != 2) {
-        fprintf(stderr, "usage: %s file\n", argv[0]);
+    threads = 0;
+    top = 0;
+    saving = false;
+    width = 0;
+    depth = DEPTH;
+
+    while (argc > 3 && argv[1][0] == '-') {
+	if (strcmp(argv[1], "-j") == 0)
+	    threads = atoi(argv[2]);
+	else if (strcmp(argv[1], "-k") == 0)
+	    top = atoi(argv[2]);
+	else if (strcmp(argv[1], "-s") == 0) {
+	    top = atoi(argv[2]);
+	    saving = true;
+	} else if (strcmp(argv[1], "-c") == 0)
+	    width = atoi(argv[2]);
+	else if (strcmp(argv[1], "-d") == 0)
+	    depth = atoi(argv[2]);
+	else
+	    break;
+
+	argc -= 2;
+
+	for (i = 1; i < argc; i ++)
+	    argv[i] = argv[i + 2];
+    }
+
+    if (argc != 2 || threads < 0 || threads > MAX_THREADS || top < 0 ||
+	width < 0 || depth <= 0 || depth > MAX_DEPTH ||
+	(saving && (threads > 0 || top == 0)) ||
+	(width > 0 && (threads > 0 || top == 0 || saving))) {
+        fprintf(stderr, "usage: %s [-j threads] [-k top | -s top] file\n",
+		argv[0]);
+        fprintf(stderr, "       %s -c width [-d depth] -k top file\n",
+		argv[0]);
         exit(EXIT_FAILURE);
     }
 
-    if ((fp = fopen(argv[1], "r")) == NULL) {
+    wp = NULL;
+    fd = -1;
+
+    if (threads > 0)
+	fd = open(argv[1], O_RDONLY);
+    else
+	wp = openWords(argv[1]);
+
+    if (fd < 0 && wp == NULL) {
         fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
         exit(EXIT_FAILURE);
     }
 
 
-    /* Increment the count on each word read. */
+    /* The Space-Saving counters and the sketch are kept apart from the
+       count table. */
 
-    counts = createSet(MAX_SIZE, compareEntries, hashEntry);
+    if (saving || width > 0) {
+	if (saving)
+	    spaceSaving(wp, top);
+	else
+	    sketchTop(wp, width, depth, top);
 
-    while (fscanf(fp, "%s", buffer) == 1) {
-	e.word = buffer;
-	ep = findElement(counts, &e);
+	closeWords(wp);
+	exit(EXIT_SUCCESS);
+    }
 
-	if (ep == NULL) {
-	    ep = malloc(sizeof(struct entry));
-	    assert(ep != NULL);
 
-	    ep->word = strdup(buffer);
-	    assert(ep->word != NULL);
+    /* Count the words in parallel if asked to.  Otherwise, increment the
+       count on each word read, adding a new entry in the same search if
+       the word has not been seen before.  The word is looked up as a
+       temporary string, and only a new entry keeps a copy of it. */
 
-	    ep->count = 1;
-	    addElement(counts, ep);
+    if (threads > 0)
+	counts = countWords(fd, threads, MAX_SIZE);
+    else {
+	counts = createSet(MAX_SIZE, compareEntries, hashEntry);
 
-	} else
-	    ep->count ++;
+	while ((word = nextWord(wp, &length)) != NULL) {
+	    e.word = termWord(wp, word, length);
+	    slot = (struct entry **) findOrAddElement(counts, &e);
+
+	    if (*slot == &e) {
+		ep = malloc(sizeof(struct entry));
+		assert(ep != NULL);
+
+		ep->word = keepWord(wp, word, length);
+		ep->count = 0;
+		*slot = ep;
+	    }
+
+	    (*slot)->count ++;
+	}
     }
 
 
-    /* Print out the counts for each word. */
+    /* Print out the counts for each word straight from the set, or only
+       the most frequent words, and then walk the set again to free the
+       entries. */
 
-    entries = getElements(counts);
+    if (top > 0)
+	printTop(counts, top);
+    else
+	forEachElement(counts, printEntry, stdout);
 
-    for (i = 0; i < numElements(counts); i ++) {
-	printf("%s: %d\n", entries[i]->word, entries[i]->count);
-	free(entries[i]->word);
-	free(entries[i]);
-    }
+    beginElements(counts, &cursor);
+
+    while ((ep = nextElement(counts, &cursor)) != NULL) {
+	if (threads > 0)
+	    free(ep->word);
 
-    free(entries);
+	free(ep);
+    }
 
     destroySet(counts);
+
+    if (threads > 0)
+	close(fd);
+    else
+	closeWords(wp);
+
     exit(EXIT_SUCCESS);
 }
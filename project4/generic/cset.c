@@ -0,0 +1,167 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "set.h"
+#include "cset.h"
+
+#define MAX_SHARDS 1024
+#define LINE_SIZE 64
+
+struct shard
+{
+	pthread_mutex_t lock;
+	SET *sp;
+	char pad[LINE_SIZE];
+};
+
+struct cset
+{
+	struct shard *shards;
+	int bits;
+	unsigned (*hash)();
+};
+
+static struct shard *pick(CSET *cp, unsigned hash);
+
+
+// Creates the concurrent set with the given number of shards rounded up to a power of two; Each shard is a set of its own with its own lock, and is padded so that the locks of two shards never share a cache line
+// O(n)
+CSET *createCSet(int shards, int maxElts, int (*compare)(), unsigned (*hash)())
+{
+	int i, n;
+	CSET *cp=malloc(sizeof(CSET));
+	assert(cp!=NULL && compare!=NULL && hash!=NULL);
+	assert(shards>0 && shards<=MAX_SHARDS);
+	for(cp->bits=0;(1<<cp->bits)<shards;cp->bits++)
+		;
+	n=1<<cp->bits;
+	cp->shards=malloc(sizeof(struct shard)*n);
+	assert(cp->shards!=NULL);
+	for(i=0;i<n;i++)
+	{
+		pthread_mutex_init(&cp->shards[i].lock, NULL);
+		cp->shards[i].sp=createSet(maxElts/n, compare, hash);
+	}
+	cp->hash=hash;
+	return cp;
+}
+
+// Frees up the memory allocated to the concurrent set, which must no longer be in use by any thread
+// O(n)
+void destroyCSet(CSET *cp)
+{
+	assert(cp!=NULL);
+	int i;
+	for(i=0;i<(1<<cp->bits);i++)
+	{
+		destroySet(cp->shards[i].sp);
+		pthread_mutex_destroy(&cp->shards[i].lock);
+	}
+	free(cp->shards);
+	free(cp);
+}
+
+// Returns the number of elements in the concurrent set by adding up the counts of the shards; While other threads are changing the set, the result is only a snapshot
+// O(shards)
+int numCElements(CSET *cp)
+{
+	assert(cp!=NULL);
+	int i, count=0;
+	for(i=0;i<(1<<cp->bits);i++)
+	{
+		pthread_mutex_lock(&cp->shards[i].lock);
+		count+=numElements(cp->shards[i].sp);
+		pthread_mutex_unlock(&cp->shards[i].lock);
+	}
+	return count;
+}
+
+// Adds the element to the shard that it belongs to while holding the lock of that shard; The element is hashed once, before the lock is taken, and the hash value both picks the shard and is passed down to the set of the shard, as it is in the calls below
+// O(1) expected
+void addCElement(CSET *cp, void *elt)
+{
+	assert(cp!=NULL && elt!=NULL);
+	unsigned hash=(*cp->hash)(elt);
+	struct shard *shp=pick(cp, hash);
+	pthread_mutex_lock(&shp->lock);
+	addHashedElement(shp->sp, elt, hash);
+	pthread_mutex_unlock(&shp->lock);
+}
+
+// Removes the element from the shard that it belongs to while holding the lock of that shard
+// O(1) expected
+void removeCElement(CSET *cp, void *elt)
+{
+	assert(cp!=NULL && elt!=NULL);
+	unsigned hash=(*cp->hash)(elt);
+	struct shard *shp=pick(cp, hash);
+	pthread_mutex_lock(&shp->lock);
+	removeHashedElement(shp->sp, elt, hash);
+	pthread_mutex_unlock(&shp->lock);
+}
+
+// Finds the element matching elt in the shard that it belongs to while holding the lock of that shard, and returns the stored element or NULL
+// O(1) expected
+void *findCElement(CSET *cp, void *elt)
+{
+	assert(cp!=NULL && elt!=NULL);
+	void *found;
+	unsigned hash=(*cp->hash)(elt);
+	struct shard *shp=pick(cp, hash);
+	pthread_mutex_lock(&shp->lock);
+	found=findHashedElement(shp->sp, elt, hash);
+	pthread_mutex_unlock(&shp->lock);
+	return found;
+}
+
+// Finds the element matching elt or adds a new one, and then updates it, all in one search and under one hold of the lock of the shard; If there is no matching element, the element returned by (*create)(elt) is added in place of elt, so that elt can be a temporary. Then (*update)() is called on the stored element, if given, while the lock is still held. The stored element is returned, but the caller must not change it afterwards without its own synchronization
+// O(1) expected
+void *updateCElement(CSET *cp, void *elt, void *(*create)(), void (*update)())
+{
+	assert(cp!=NULL && elt!=NULL && create!=NULL);
+	void **slot, *stored;
+	unsigned hash=(*cp->hash)(elt);
+	struct shard *shp=pick(cp, hash);
+	pthread_mutex_lock(&shp->lock);
+	slot=findOrAddHashedElement(shp->sp, elt, hash);
+	if(*slot==elt)
+	{
+		*slot=(*create)(elt);
+		assert(*slot!=NULL);
+	}
+	stored=*slot;
+	if(update!=NULL)
+		(*update)(stored);
+	pthread_mutex_unlock(&shp->lock);
+	return stored;
+}
+
+// Allocates memory to a new array that holds the elements of every shard; It must not be called while other threads are changing the set
+// O(n)
+void *getCElements(CSET *cp)
+{
+	assert(cp!=NULL);
+	int i, n, count=0;
+	void **elts, **temp=malloc(sizeof(void*)*numCElements(cp));
+	assert(temp!=NULL);
+	for(i=0;i<(1<<cp->bits);i++)
+	{
+		n=numElements(cp->shards[i].sp);
+		elts=getElements(cp->shards[i].sp);
+		memcpy(temp+count, elts, sizeof(void*)*n);
+		count+=n;
+		free(elts);
+	}
+	return temp;
+}
+
+// Returns the shard that an element with the given hash value belongs to, which is picked by the high bits of the hash value after a multiplication by the golden ratio; The shards themselves use a different mix of the hash value, so the bits that pick the shard are not the ones that pick the slot within it
+// O(1)
+static struct shard *pick(CSET *cp, unsigned hash)
+{
+	hash*=0x9e3779b9u;
+	if(cp->bits==0)
+		return &cp->shards[0];
+	return &cp->shards[hash>>(32-cp->bits)];
+}
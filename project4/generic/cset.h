@@ -0,0 +1,32 @@
+/*
+ * File:        cset.h
+ *
+ * Description: This file contains the public function and type
+ *              declarations for a concurrent set abstract data type for
+ *              generic pointer types.  The set may be used by several
+ *              threads at once.  Its elements are striped across several
+ *              independently locked sets.
+ */
+
+# ifndef CSET_H
+# define CSET_H
+
+typedef struct cset CSET;
+
+CSET *createCSet(int shards, int maxElts, int (*compare)(), unsigned (*hash)());
+
+void destroyCSet(CSET *cp);
+
+int numCElements(CSET *cp);
+
+void addCElement(CSET *cp, void *elt);
+
+void removeCElement(CSET *cp, void *elt);
+
+void *findCElement(CSET *cp, void *elt);
+
+void *updateCElement(CSET *cp, void *elt, void *(*create)(), void (*update)());
+
+void *getCElements(CSET *cp);
+
+# endif /* CSET_H */
@@ -0,0 +1,701 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "set.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define WAYS 4
+#define STASH_SIZE 8
+#define MIN_LENGTH 4
+#define MAX_LOAD(n) ((n)/20*19)
+#define MAX_NODES 512
+#define BATCH_SIZE 64
+
+#define ALT_SEED 0x5bd1e995
+
+#ifdef SET_STATS
+#define COMPARE(sp, x, y) ((sp)->compares++, (*(sp)->compare)((x), (y)))
+#else
+#define COMPARE(sp, x, y) ((*(sp)->compare)((x), (y)))
+#endif
+
+struct bucket
+{
+	unsigned hashes[WAYS];
+	void *data[WAYS];
+} __attribute__((aligned(64)));
+
+struct set
+{
+	struct bucket *buckets;
+	int length;
+	int count;
+	int stashed;
+	int stashSize;
+	void **stash;
+	unsigned *stashHashes;
+	int (*compare)();
+	unsigned (*hash)();
+#ifdef SET_STATS
+	long compares;
+#endif
+};
+
+struct node
+{
+	int bucket;
+	int parent;
+	int slot;
+};
+
+static struct bucket *allocBuckets(int length);
+static void **lookup(SET *sp, void *elt, unsigned hash);
+static void **insert(SET *sp, void *elt, unsigned hash);
+static void **place(SET *sp, void *elt, unsigned hash);
+static int findPath(SET *sp, unsigned hash, struct node *nodes, int *slot);
+static void erase(SET *sp, void **slot);
+static void unstash(SET *sp, int b, int k);
+static void **overflow(SET *sp, void *elt, unsigned hash);
+static void grow(SET *sp);
+static void rehash(SET *sp, int length);
+static int freeSlot(struct bucket *bp);
+static int first(SET *sp, unsigned hash);
+static int second(SET *sp, unsigned hash);
+static int other(SET *sp, unsigned hash, int b);
+static void prefetch(SET *sp, void **elts, int n, unsigned *hashes);
+static unsigned mix(unsigned hash);
+static SET *cloneSet(SET *sp);
+static SET *keepFound(SET *sp1, SET *walked, SET *probed, bool found);
+
+
+// Creates a set without any of the options of createSetWith
+// O(n)
+SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)())
+{
+	return createSetWith(maxElts, compare, hash, 0);
+}
+
+// Creates and allocates memory to the set, which is a bucketized cuckoo hash table. The table is an array of buckets of WAYS slots each, and every element may only be stored in one of two buckets picked by its hash value, or in a small stash for the rare element that fits in neither. Each bucket holds the stored hash values and element pointers of its slots and is aligned to a cache line of its own. The table is sized so that maxElts elements fit under the maximum load factor, but maxElts is only a hint: the set grows by itself when it is needed. SET_BLOOM is accepted in flags but ignored, since a lookup that misses reads no more of the table than one that hits, and a Bloom filter would only add a third cache line to it. So are SET_QUADRATIC and SET_DOUBLE, since an element can only ever be in one of its two buckets
+// O(n)
+SET *createSetWith(int maxElts, int (*compare)(), unsigned (*hash)(), int flags)
+{
+	int length=MIN_LENGTH;
+	SET *sp = malloc(sizeof(SET));
+	assert(sp!=NULL && compare!=NULL && hash!=NULL && (flags&~(SET_BLOOM|SET_QUADRATIC|SET_DOUBLE))==0);
+	while(MAX_LOAD(length*WAYS)<maxElts)
+		length*=2;
+	sp->buckets=allocBuckets(length);
+	sp->length=length;
+	sp->count=0;
+	sp->stashed=0;
+	sp->stashSize=STASH_SIZE;
+	sp->stash=malloc(sizeof(void*)*STASH_SIZE);
+	sp->stashHashes=malloc(sizeof(unsigned)*STASH_SIZE);
+	assert(sp->stash!=NULL && sp->stashHashes!=NULL);
+	sp->compare=compare;
+	sp->hash=hash;
+#ifdef SET_STATS
+	sp->compares=0;
+#endif
+	return sp;
+}
+
+// Frees up the memory allocated to the set
+// O(1)
+void destroySet(SET *sp)
+{
+	assert(sp!=NULL);
+	free(sp->buckets);
+	free(sp->stash);
+	free(sp->stashHashes);
+	free(sp);
+}
+
+// Returns the number of elements in the set, including those in the stash
+// O(1)
+int numElements(SET *sp)
+{
+	assert(sp!=NULL);
+	return sp->count;
+}
+
+// Adds the element to the set assuming that the element is not already in the set, whose hash value given by the hash function of the set is hash; If both of its buckets are full, elements are moved to their other buckets to make room, and the table grows if no room can be made
+// O(1) expected
+void addHashedElement(SET *sp, void *elt, unsigned hash)
+{
+	assert(sp!=NULL && elt!=NULL);
+	hash=mix(hash);
+	if(lookup(sp, elt, hash)==NULL)
+		insert(sp, elt, hash);
+}
+
+// Removes the element from the set, assuming that the element is in the set and that its hash value given by the hash function of the set is hash
+// O(1)
+void removeHashedElement(SET *sp, void *elt, unsigned hash)
+{
+	assert(sp!=NULL && elt!=NULL);
+	void **slot=lookup(sp, elt, mix(hash));
+	if(slot!=NULL)
+		erase(sp, slot);
+}
+
+// Public search function that finds the element matching void *elt, whose hash value given by the hash function of the set is hash, and returns the element stored in the set if found. Else, it returns NULL to indicate that the element was not found. Only the two buckets of the element are searched, along with the stash if it is not empty, so no lookup takes more than two cache lines of the table no matter how full it is
+// O(1)
+void *findHashedElement(SET *sp, void *elt, unsigned hash)
+{
+	assert(sp!=NULL && elt!=NULL);
+	void **slot=lookup(sp, elt, mix(hash));
+	if(slot==NULL)
+		return NULL;
+	return *slot;
+}
+
+// Finds the element matching void *elt or adds elt if there is none, given the hash value of elt from the hash function of the set; It returns the address of the slot that holds the matching element, so the caller can tell the two cases apart by checking whether the slot holds elt itself. The caller may store a different but equal element in the slot. The address is only valid until the next call that changes the set, since adding an element may move others between their buckets
+// O(1) expected
+void **findOrAddHashedElement(SET *sp, void *elt, unsigned hash)
+{
+	assert(sp!=NULL && elt!=NULL);
+	hash=mix(hash);
+	void **slot=lookup(sp, elt, hash);
+	if(slot!=NULL)
+		return slot;
+	return insert(sp, elt, hash);
+}
+
+// Adds the element to the set as addHashedElement does, computing its hash value with the hash function of the set
+// O(1) expected
+void addElement(SET *sp, void *elt)
+{
+	assert(sp!=NULL && elt!=NULL);
+	addHashedElement(sp, elt, (*sp->hash)(elt));
+}
+
+// Removes the element from the set as removeHashedElement does, computing its hash value with the hash function of the set
+// O(1)
+void removeElement(SET *sp, void *elt)
+{
+	assert(sp!=NULL && elt!=NULL);
+	removeHashedElement(sp, elt, (*sp->hash)(elt));
+}
+
+// Finds the element matching void *elt as findHashedElement does, computing its hash value with the hash function of the set
+// O(1)
+void *findElement(SET *sp, void *elt)
+{
+	assert(sp!=NULL && elt!=NULL);
+	return findHashedElement(sp, elt, (*sp->hash)(elt));
+}
+
+// Finds the element matching void *elt or adds elt as findOrAddHashedElement does, computing its hash value with the hash function of the set
+// O(1) expected
+void **findOrAddElement(SET *sp, void *elt)
+{
+	assert(sp!=NULL && elt!=NULL);
+	return findOrAddHashedElement(sp, elt, (*sp->hash)(elt));
+}
+
+// Removes the element held in the slot at the given address, which must have been returned by findOrAddElement since the set was last changed
+// O(1)
+void removeSlot(SET *sp, void **slot)
+{
+	assert(sp!=NULL && slot!=NULL && *slot!=NULL);
+	assert((slot>=sp->stash && slot<sp->stash+sp->stashed) || ((char *)slot>=(char *)sp->buckets && (char *)slot<(char *)(sp->buckets+sp->length)));
+	erase(sp, slot);
+}
+
+// Adds each of the n elements of the array elts to the set as addElement does, in order. The elements are taken BATCH_SIZE at a time: all of their hash values are computed and both of their buckets are prefetched before any of them is searched for, so the cache misses of the whole batch overlap
+// O(n) expected
+void addElements(SET *sp, void **elts, int n)
+{
+	assert(sp!=NULL && (elts!=NULL || n==0));
+	int i, j, m;
+	unsigned hashes[BATCH_SIZE];
+	for(i=0;i<n;i+=BATCH_SIZE)
+	{
+		m=n-i<BATCH_SIZE ? n-i : BATCH_SIZE;
+		prefetch(sp, elts+i, m, hashes);
+		for(j=0;j<m;j++)
+			if(lookup(sp, elts[i+j], hashes[j])==NULL)
+				insert(sp, elts[i+j], hashes[j]);
+	}
+}
+
+// Looks up each of the n elements of the array elts as findElement does, and stores the element found in the set, or NULL, in the same position of the array results. The buckets of a batch are prefetched first, as in addElements
+// O(n)
+void findElements(SET *sp, void **elts, int n, void **results)
+{
+	assert(sp!=NULL && ((elts!=NULL && results!=NULL) || n==0));
+	int i, j, m;
+	void **slot;
+	unsigned hashes[BATCH_SIZE];
+	for(i=0;i<n;i+=BATCH_SIZE)
+	{
+		m=n-i<BATCH_SIZE ? n-i : BATCH_SIZE;
+		prefetch(sp, elts+i, m, hashes);
+		for(j=0;j<m;j++)
+		{
+			slot=lookup(sp, elts[i+j], hashes[j]);
+			results[i+j]=slot!=NULL ? *slot : NULL;
+		}
+	}
+}
+
+// Allocates memory to a new array that holds the elements of the set to be returned to the interface, taken from the buckets in order and then from the stash
+// O(n)
+void *getElements(SET *sp)
+{
+	assert(sp!=NULL);
+	int i=0;
+	void *elt, **elts=malloc(sizeof(void*)*sp->count);
+	CURSOR c;
+	assert(elts!=NULL || sp->count==0);
+	beginElements(sp, &c);
+	while((elt=nextElement(sp, &c))!=NULL)
+		elts[i++]=elt;
+	return elts;
+}
+
+// Starts a traversal of the set with the cursor pointed to by cp, which the caller allocates; The cursor index runs over the slots of all buckets and then over the stash
+// O(1)
+void beginElements(SET *sp, CURSOR *cp)
+{
+	assert(sp!=NULL && cp!=NULL);
+	cp->index=0;
+}
+
+// Returns the next element of the traversal with the cursor pointed to by cp, or NULL once every element has been visited. The set must not be changed during the traversal
+// O(1) amortized
+void *nextElement(SET *sp, CURSOR *cp)
+{
+	assert(sp!=NULL && cp!=NULL);
+	int slots=sp->length*WAYS;
+	void *elt;
+	while(cp->index<slots)
+	{
+		elt=sp->buckets[cp->index/WAYS].data[cp->index%WAYS];
+		cp->index++;
+		if(elt!=NULL)
+			return elt;
+	}
+	if(cp->index-slots<sp->stashed)
+		return sp->stash[cp->index++-slots];
+	return NULL;
+}
+
+// Calls (*visit)(elt, arg) on each element of the set in the order of nextElement
+// O(n)
+void forEachElement(SET *sp, void (*visit)(), void *arg)
+{
+	assert(sp!=NULL && visit!=NULL);
+	int i, k;
+	for(i=0;i<sp->length;i++)
+		for(k=0;k<WAYS;k++)
+			if(sp->buckets[i].data[k]!=NULL)
+				(*visit)(sp->buckets[i].data[k], arg);
+	for(i=0;i<sp->stashed;i++)
+		(*visit)(sp->stash[i], arg);
+}
+
+// Returns a new set that holds the elements that are in either set, which must have the same compare and hash functions. The larger set is copied wholesale by cloneSet and the elements of the smaller one are added to the copy as addElements does, so only the smaller set is walked. Where both sets hold equal elements, the new set keeps the one from the first set, so if the copy is of the second set, an element of the first set that it finds takes the place of the equal one
+// O(n+m) expected
+SET *setUnion(SET *sp1, SET *sp2)
+{
+	assert(sp1!=NULL && sp2!=NULL && sp1->compare==sp2->compare && sp1->hash==sp2->hash);
+	int i, j, m;
+	unsigned hashes[BATCH_SIZE];
+	SET *small=sp1->count<sp2->count ? sp1 : sp2;
+	SET *sp=cloneSet(small==sp1 ? sp2 : sp1);
+	void **slot, **elts=getElements(small);
+	for(i=0;i<small->count;i+=BATCH_SIZE)
+	{
+		m=small->count-i<BATCH_SIZE ? small->count-i : BATCH_SIZE;
+		prefetch(sp, elts+i, m, hashes);
+		for(j=0;j<m;j++)
+		{
+			if((slot=lookup(sp, elts[i+j], hashes[j]))==NULL)
+				insert(sp, elts[i+j], hashes[j]);
+			else if(small==sp1)
+				*slot=elts[i+j];
+		}
+	}
+	free(elts);
+	return sp;
+}
+
+// Returns a new set that holds the elements that are in both sets, which must have the same compare and hash functions, by looking up the elements of the smaller set in the larger one with keepFound. The new set holds the elements of the first set
+// O(min(n, m)) expected
+SET *setIntersect(SET *sp1, SET *sp2)
+{
+	assert(sp1!=NULL && sp2!=NULL && sp1->compare==sp2->compare && sp1->hash==sp2->hash);
+	if(sp1->count<=sp2->count)
+		return keepFound(sp1, sp1, sp2, true);
+	return keepFound(sp1, sp2, sp1, true);
+}
+
+// Returns a new set that holds the elements of the first set that are not in the second, which must have the same compare and hash functions. If the first set is the smaller one, its elements that the second set does not hold are picked out with keepFound. Otherwise, the first set is copied wholesale by cloneSet and the elements of the second set are removed from the copy, so neither set is changed
+// O(n) expected
+SET *setDifference(SET *sp1, SET *sp2)
+{
+	assert(sp1!=NULL && sp2!=NULL && sp1->compare==sp2->compare && sp1->hash==sp2->hash);
+	int i;
+	SET *sp;
+	void **elts;
+	if(sp1->count<=sp2->count)
+		return keepFound(sp1, sp1, sp2, false);
+	sp=cloneSet(sp1);
+	elts=getElements(sp2);
+	for(i=0;i<sp2->count;i++)
+		removeElement(sp, elts[i]);
+	free(elts);
+	return sp;
+}
+
+// Fills in the statistics pointed to by stats, where a probe is one bucket. An element in its first bucket is found after one probe and one in its second bucket after two, while a miss always reads both buckets. The stash counts as one more probe, for the elements in it and for every miss while it holds any elements. There are no tombstones, since a removed element just leaves its slot empty
+// O(n)
+void getSetStats(SET *sp, STATS *stats)
+{
+	assert(sp!=NULL && stats!=NULL);
+	int i, k, probes;
+	struct bucket *bp;
+	memset(stats, 0, sizeof(STATS));
+	stats->count=sp->count;
+	stats->length=sp->length*WAYS;
+	stats->load=(double)sp->count/stats->length;
+	for(i=0;i<sp->length;i++)
+	{
+		bp=&sp->buckets[i];
+		for(k=0;k<WAYS;k++)
+			if(bp->data[k]!=NULL)
+			{
+				probes=first(sp, bp->hashes[k])==i ? 1 : 2;
+				stats->hitProbes+=probes;
+				stats->histogram[probes]++;
+			}
+	}
+	stats->hitProbes+=3*sp->stashed;
+	stats->histogram[3]+=sp->stashed;
+	if(sp->count>0)
+		stats->hitProbes/=sp->count;
+	stats->maxHit=sp->stashed>0 ? 3 : stats->histogram[2]>0 ? 2 : sp->count>0;
+	stats->maxMiss=sp->stashed>0 ? 3 : 2;
+	stats->missProbes=stats->maxMiss;
+#ifdef SET_STATS
+	stats->compares=sp->compares;
+#else
+	stats->compares=-1;
+#endif
+}
+
+// Allocates an array of the given number of empty buckets, each aligned to a cache line
+// O(n)
+static struct bucket *allocBuckets(int length)
+{
+	struct bucket *buckets=aligned_alloc(sizeof(struct bucket), sizeof(struct bucket)*length);
+	assert(buckets!=NULL);
+	memset(buckets, 0, sizeof(struct bucket)*length);
+	return buckets;
+}
+
+// Private search function that finds the element pointed to by void *elt and returns the address of its slot, or NULL if it is not in the set. The slots of both buckets are checked, and the compare function is only called for the slots whose stored hash value matches. The stash is only searched if it holds any elements
+// O(1)
+static void **lookup(SET *sp, void *elt, unsigned hash)
+{
+	int i, k;
+	struct bucket *bp=&sp->buckets[first(sp, hash)];
+	for(i=0;i<2;i++)
+	{
+		for(k=0;k<WAYS;k++)
+			if(bp->hashes[k]==hash && bp->data[k]!=NULL && COMPARE(sp, bp->data[k], elt)==0)
+				return &bp->data[k];
+		bp=&sp->buckets[second(sp, hash)];
+	}
+	for(i=0;i<sp->stashed;i++)
+		if(sp->stashHashes[i]==hash && COMPARE(sp, sp->stash[i], elt)==0)
+			return &sp->stash[i];
+	return NULL;
+}
+
+// Adds an element that is not in the set and returns the address of its slot; The table grows first if the load factor would be crossed. If the element then cannot be placed, the table grows once more, but only if it is at least half full, since a bucket only depends on the hash value and no number of buckets can fit more than 2*WAYS+STASH_SIZE elements with the same hash value. An element that still cannot be placed is added to the stash past STASH_SIZE by overflow, so that many equal hash values make the stash longer instead of making the table grow without end
+// O(1) expected
+static void **insert(SET *sp, void *elt, unsigned hash)
+{
+	void **slot;
+	if(sp->count>=MAX_LOAD(sp->length*WAYS))
+		grow(sp);
+	if((slot=place(sp, elt, hash))==NULL && sp->count>=MAX_LOAD(sp->length*WAYS)/2)
+	{
+		grow(sp);
+		slot=place(sp, elt, hash);
+	}
+	if(slot==NULL)
+		slot=overflow(sp, elt, hash);
+	sp->count++;
+	return slot;
+}
+
+// Stores the element in a free slot of one of its buckets and returns the address of the slot, without updating the count. If both buckets are full, a breadth-first search finds the shortest chain of elements that can each be moved to their other bucket, ending at a bucket with a free slot; the chain is then shifted along from its far end, so the element ends up in one of its own buckets and no element is ever left without a slot. If no chain is found within MAX_NODES buckets, the element goes into the stash, and NULL is returned if the stash is full as well
+// O(1) expected
+static void **place(SET *sp, void *elt, unsigned hash)
+{
+	int j, k, p, slot;
+	struct bucket *bp, *from;
+	struct node nodes[MAX_NODES];
+	int b[2]={first(sp, hash), second(sp, hash)};
+	for(j=0;j<2;j++)
+	{
+		bp=&sp->buckets[b[j]];
+		if((k=freeSlot(bp))>=0)
+		{
+			bp->hashes[k]=hash;
+			bp->data[k]=elt;
+			return &bp->data[k];
+		}
+	}
+	if((j=findPath(sp, hash, nodes, &slot))>=0)
+	{
+		while(nodes[j].parent>=0)
+		{
+			p=nodes[j].parent;
+			k=nodes[j].slot;
+			bp=&sp->buckets[nodes[j].bucket];
+			from=&sp->buckets[nodes[p].bucket];
+			bp->hashes[slot]=from->hashes[k];
+			bp->data[slot]=from->data[k];
+			slot=k;
+			j=p;
+		}
+		bp=&sp->buckets[nodes[j].bucket];
+		bp->hashes[slot]=hash;
+		bp->data[slot]=elt;
+		return &bp->data[slot];
+	}
+	if(sp->stashed<STASH_SIZE)
+	{
+		sp->stashHashes[sp->stashed]=hash;
+		sp->stash[sp->stashed]=elt;
+		return &sp->stash[sp->stashed++];
+	}
+	return NULL;
+}
+
+// Searches breadth-first from the two full buckets of an element with the given hash value for a bucket with a free slot. Each node of the search is a bucket, reached from its parent by moving the element in the given slot of the parent to its other bucket. No bucket is visited twice, so the buckets along the chain are distinct and it can be shifted without an element being moved twice. It returns the index of the node with a free slot and sets *slot to that slot, or returns -1 if none is found
+// O(MAX_NODES^2) worst case, O(1) expected
+static int findPath(SET *sp, unsigned hash, struct node *nodes, int *slot)
+{
+	int i, j, k, n=2, alt;
+	struct bucket *bp;
+	nodes[0].bucket=first(sp, hash);
+	nodes[1].bucket=second(sp, hash);
+	nodes[0].parent=nodes[1].parent=-1;
+	for(i=0;i<n;i++)
+	{
+		bp=&sp->buckets[nodes[i].bucket];
+		for(k=0;k<WAYS && n<MAX_NODES;k++)
+		{
+			alt=other(sp, bp->hashes[k], nodes[i].bucket);
+			for(j=0;j<n && nodes[j].bucket!=alt;j++)
+				;
+			if(j<n)
+				continue;
+			nodes[n].bucket=alt;
+			nodes[n].parent=i;
+			nodes[n].slot=k;
+			if((*slot=freeSlot(&sp->buckets[alt]))>=0)
+				return n;
+			n++;
+		}
+	}
+	return -1;
+}
+
+// Empties the slot at the given address and updates the count. A slot of the stash is filled with the last element of the stash, so the stash stays packed. A slot of a bucket is offered to the elements of the stash, so that the stash empties out again as the table does
+// O(1)
+static void erase(SET *sp, void **slot)
+{
+	int b, k;
+	sp->count--;
+	if(slot>=sp->stash && slot<sp->stash+sp->stashed)
+	{
+		k=slot-sp->stash;
+		sp->stashed--;
+		sp->stash[k]=sp->stash[sp->stashed];
+		sp->stashHashes[k]=sp->stashHashes[sp->stashed];
+		return;
+	}
+	b=((char *)slot-(char *)sp->buckets)/sizeof(struct bucket);
+	k=slot-sp->buckets[b].data;
+	*slot=NULL;
+	if(sp->stashed>0)
+		unstash(sp, b, k);
+}
+
+// Moves an element of the stash whose buckets include bucket b into its free slot k, if there is one
+// O(1)
+static void unstash(SET *sp, int b, int k)
+{
+	int i;
+	unsigned hash;
+	for(i=0;i<sp->stashed;i++)
+	{
+		hash=sp->stashHashes[i];
+		if(first(sp, hash)==b || second(sp, hash)==b)
+		{
+			sp->buckets[b].hashes[k]=hash;
+			sp->buckets[b].data[k]=sp->stash[i];
+			sp->stashed--;
+			sp->stash[i]=sp->stash[sp->stashed];
+			sp->stashHashes[i]=sp->stashHashes[sp->stashed];
+			return;
+		}
+	}
+}
+
+// Adds the element to the end of the stash, past the STASH_SIZE elements that place may put there, and returns the address of its slot. The stash doubles in size when it is full
+// O(1) amortized
+static void **overflow(SET *sp, void *elt, unsigned hash)
+{
+	if(sp->stashed==sp->stashSize)
+	{
+		sp->stashSize*=2;
+		sp->stash=realloc(sp->stash, sizeof(void*)*sp->stashSize);
+		sp->stashHashes=realloc(sp->stashHashes, sizeof(unsigned)*sp->stashSize);
+		assert(sp->stash!=NULL && sp->stashHashes!=NULL);
+	}
+	sp->stashHashes[sp->stashed]=hash;
+	sp->stash[sp->stashed]=elt;
+	return &sp->stash[sp->stashed++];
+}
+
+// Doubles the number of buckets
+// O(n)
+static void grow(SET *sp)
+{
+	rehash(sp, sp->length*2);
+}
+
+// Moves every element, including those in the stash, into a new array of the given number of buckets using their stored hash values, so the hash function is not called again. An element that cannot be placed is added to the stash by overflow, so every element always finds a slot
+// O(n)
+static void rehash(SET *sp, int length)
+{
+	int i, k, stashed=sp->stashed, oldLength=sp->length;
+	void **stash=sp->stash;
+	unsigned *stashHashes=sp->stashHashes;
+	struct bucket *old=sp->buckets;
+	sp->buckets=allocBuckets(length);
+	sp->length=length;
+	sp->stashed=0;
+	sp->stashSize=STASH_SIZE;
+	sp->stash=malloc(sizeof(void*)*STASH_SIZE);
+	sp->stashHashes=malloc(sizeof(unsigned)*STASH_SIZE);
+	assert(sp->stash!=NULL && sp->stashHashes!=NULL);
+	for(i=0;i<oldLength;i++)
+		for(k=0;k<WAYS;k++)
+			if(old[i].data[k]!=NULL && place(sp, old[i].data[k], old[i].hashes[k])==NULL)
+				overflow(sp, old[i].data[k], old[i].hashes[k]);
+	for(i=0;i<stashed;i++)
+		if(place(sp, stash[i], stashHashes[i])==NULL)
+			overflow(sp, stash[i], stashHashes[i]);
+	free(old);
+	free(stash);
+	free(stashHashes);
+}
+
+// Returns the index of a free slot in the bucket pointed to by bp, or -1 if it is full
+// O(1)
+static int freeSlot(struct bucket *bp)
+{
+	int k;
+	for(k=0;k<WAYS;k++)
+		if(bp->data[k]==NULL)
+			return k;
+	return -1;
+}
+
+// Returns the first bucket of an element, which is taken from the low bits of its mixed hash value
+// O(1)
+static int first(SET *sp, unsigned hash)
+{
+	return hash&(sp->length-1);
+}
+
+// Returns the second bucket of an element, which is taken from the low bits of its mixed hash value mixed again with a different seed, and is made to differ from the first bucket
+// O(1)
+static int second(SET *sp, unsigned hash)
+{
+	int b1=first(sp, hash), b2=mix(hash^ALT_SEED)&(sp->length-1);
+	return b2!=b1 ? b2 : b1^1;
+}
+
+// Returns the bucket of an element other than bucket b, which must be one of its two buckets
+// O(1)
+static int other(SET *sp, unsigned hash, int b)
+{
+	int b1=first(sp, hash);
+	return b1!=b ? b1 : second(sp, hash);
+}
+
+// Computes the mixed hash values of the n elements of the array elts into the array hashes and prefetches both buckets of each element
+// O(n)
+static void prefetch(SET *sp, void **elts, int n, unsigned *hashes)
+{
+	int i;
+	for(i=0;i<n;i++)
+	{
+		hashes[i]=mix((*sp->hash)(elts[i]));
+		__builtin_prefetch(&sp->buckets[first(sp, hashes[i])]);
+		__builtin_prefetch(&sp->buckets[second(sp, hashes[i])]);
+	}
+}
+
+// Returns a copy of the set that shares its elements, made by copying its buckets and stash as they are, so that no element is hashed or moved
+// O(n)
+static SET *cloneSet(SET *sp)
+{
+	SET *copy=malloc(sizeof(SET));
+	assert(copy!=NULL);
+	*copy=*sp;
+	copy->buckets=allocBuckets(sp->length);
+	memcpy(copy->buckets, sp->buckets, sizeof(struct bucket)*sp->length);
+	copy->stash=malloc(sizeof(void*)*sp->stashSize);
+	copy->stashHashes=malloc(sizeof(unsigned)*sp->stashSize);
+	assert(copy->stash!=NULL && copy->stashHashes!=NULL);
+	memcpy(copy->stash, sp->stash, sizeof(void*)*sp->stashed);
+	memcpy(copy->stashHashes, sp->stashHashes, sizeof(unsigned)*sp->stashed);
+#ifdef SET_STATS
+	copy->compares=0;
+#endif
+	return copy;
+}
+
+// Returns a new set, with the compare and hash functions of sp1, that holds the elements of the set walked that the set probed holds if found is true, or does not hold otherwise. The elements are looked up with findElements, so the buckets of each batch are prefetched, and an element that is found is replaced by the equal element of sp1 if sp1 is the set probed
+// O(n) expected
+static SET *keepFound(SET *sp1, SET *walked, SET *probed, bool found)
+{
+	int i, n=0;
+	void **elts=getElements(walked);
+	void **results=malloc(sizeof(void*)*walked->count);
+	SET *sp;
+	assert(results!=NULL || walked->count==0);
+	findElements(probed, elts, walked->count, results);
+	for(i=0;i<walked->count;i++)
+		if((results[i]!=NULL)==found)
+			elts[n++]=probed==sp1 && found ? results[i] : elts[i];
+	sp=createSet(n, sp1->compare, sp1->hash);
+	addElements(sp, elts, n);
+	free(elts);
+	free(results);
+	return sp;
+}
+
+// Mixes the bits of the hash value given by the interface; This is the finalizer of MurmurHash3
+// O(1)
+static unsigned mix(unsigned hash)
+{
+	hash^=hash>>16;
+	hash*=0x85ebca6b;
+	hash^=hash>>13;
+	hash*=0xc2b2ae35;
+	hash^=hash>>16;
+	return hash;
+}
@@ -0,0 +1,121 @@
+/*
+ * File:        growth.c
+ *
+ * Description: This file contains a benchmark for the growth of a set
+ *              abstract data type for strings.
+ *
+ *              The program inserts COUNT distinct synthetic words into a
+ *              set that starts at its minimum size, so that the set must
+ *              grow many times.  The inserts are split into windows and
+ *              the mean and maximum latency of an insert in each window
+ *              are printed.  With an incremental rehash the maximum
+ *              latency should stay flat across the growth events instead
+ *              of spiking whenever the table doubles.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <time.h>
+# include <assert.h>
+# include "set.h"
+
+
+# define DEFAULT_COUNT 10000000
+# define WINDOWS 20
+
+
+/*
+ * Function:    strhash
+ *
+ * Description: Return a hash value for a string S.
+ */
+
+static unsigned strhash(char *s)
+{
+    unsigned hash = 0;
+
+
+    while (*s != '\0')
+        hash = 31 * hash + *s ++;
+
+    return hash;
+}
+
+
+/*
+ * Function:    now
+ *
+ * Description: Return the current time in nanoseconds.
+ */
+
+static long long now(void)
+{
+    struct timespec ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    char *pool, **words;
+    long long start, elapsed, total, max;
+    int i, count, window, len;
+    SET *sp;
+
+
+    /* Check usage and build the words. */
+
+    count = argc > 1 ? atoi(argv[1]) : DEFAULT_COUNT;
+
+    if (argc > 2 || count < WINDOWS) {
+        fprintf(stderr, "usage: %s [count]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    pool = malloc((size_t) count * 12);
+    words = malloc(sizeof(char *) * count);
+    assert(pool != NULL && words != NULL);
+
+    for (i = 0, len = 0; i < count; i ++) {
+        words[i] = pool + len;
+        len += sprintf(words[i], "w%x", i * 2654435761u) + 1;
+    }
+
+
+    /* Insert the words and time each insert. */
+
+    sp = createSet(0, strcmp, strhash);
+    window = count / WINDOWS;
+    printf("%10s %12s %12s\n", "elements", "mean (ns)", "max (ns)");
+
+    for (i = 0, total = max = 0; i < count; i ++) {
+        start = now();
+        addElement(sp, words[i]);
+        elapsed = now() - start;
+
+        total += elapsed;
+        if (elapsed > max)
+            max = elapsed;
+
+        if ((i + 1) % window == 0) {
+            printf("%10d %12.1f %12lld\n", i + 1, (double) total / window, max);
+            total = max = 0;
+        }
+    }
+
+    assert(numElements(sp) == count);
+    destroySet(sp);
+    free(words);
+    free(pool);
+    exit(EXIT_SUCCESS);
+}
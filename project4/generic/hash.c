@@ -0,0 +1,54 @@
+#include <assert.h>
+#include <string.h>
+#include <stdint.h>
+#include "set.h"
+
+#define HASH_SEED 0x9e3779b9
+
+static uint64_t rotl(uint64_t x, int r);
+
+
+// Returns a hash value for the given number of bytes starting at key, which depends on the seed. The bytes are consumed 8 at a time, as in the body of MurmurHash3, and the tail is read as one zero-padded word. The result is avalanched with the 64-bit finalizer of MurmurHash3, so every input bit affects every output bit
+// O(n)
+unsigned hashBytes(void *key, int length, unsigned seed)
+{
+	assert(key!=NULL && length>=0);
+	unsigned char *p=key;
+	uint64_t h=seed^(length*0x9e3779b97f4a7c15ULL);
+	uint64_t w;
+	while(length>=8)
+	{
+		memcpy(&w, p, 8);
+		w*=0x87c37b91114253d5ULL;
+		w=rotl(w, 31);
+		w*=0x4cf5ad432745937fULL;
+		h^=w;
+		h=rotl(h, 27)*5+0x52dce729;
+		p+=8;
+		length-=8;
+	}
+	w=0;
+	memcpy(&w, p, length);
+	h^=w*0x87c37b91114253d5ULL;
+	h^=h>>33;
+	h*=0xff51afd7ed558ccdULL;
+	h^=h>>33;
+	h*=0xc4ceb9fe1a85ec53ULL;
+	h^=h>>33;
+	return (unsigned)h;
+}
+
+// Returns a hash value for the string s using hashBytes with a fixed seed; It has the signature of the hash function given to createSet, so it can be passed in place of a hash function written by the interface
+// O(n)
+unsigned hashString(char *s)
+{
+	assert(s!=NULL);
+	return hashBytes(s, strlen(s), HASH_SEED);
+}
+
+// Rotates the bits of a 64-bit word left by r places
+// O(1)
+static uint64_t rotl(uint64_t x, int r)
+{
+	return (x<<r)|(x>>(64-r));
+}
@@ -0,0 +1,209 @@
+/*
+ * File:        hashbench.c
+ *
+ * Description: This file contains a benchmark for the string hash
+ *              functions used with the set abstract data type.
+ *
+ *              The program takes one or more files as command line
+ *              arguments and reads all of their words.  It compares the
+ *              byte-at-a-time strhash function of the drivers with the
+ *              hashString function of the table library.  For each
+ *              function, the throughput of hashing every word is printed,
+ *              along with the distribution of probe lengths that result
+ *              from inserting the distinct words into a linear probing
+ *              table of a power-of-two length indexed by the raw hash.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <time.h>
+# include <assert.h>
+# include "set.h"
+
+
+# define ROUNDS 20
+# define BUCKETS 6
+
+
+/*
+ * Function:    strhash
+ *
+ * Description: Return a hash value for a string S.
+ */
+
+static unsigned strhash(char *s)
+{
+    unsigned hash = 0;
+
+
+    while (*s != '\0')
+        hash = 31 * hash + *s ++;
+
+    return hash;
+}
+
+
+/*
+ * Function:    now
+ *
+ * Description: Return the current time in nanoseconds.
+ */
+
+static long long now(void)
+{
+    struct timespec ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+/*
+ * Function:    report
+ *
+ * Description: Time the hash function HASH over the N words in WORDS,
+ *              which have BYTES bytes in total, and then insert the M
+ *              distinct words in DISTINCT into a linear probing table
+ *              indexed by the raw hash value and print the distribution
+ *              of the probe lengths.
+ */
+
+static void report(char *name, unsigned (*hash)(char *), char **words,
+                   int n, long bytes, char **distinct, int m)
+{
+    static char *labels[BUCKETS] = {"1", "2", "3-4", "5-8", "9-16", "17+"};
+    int i, r, length, probes, max, counts[BUCKETS];
+    unsigned sum, mask, idx;
+    long long start, elapsed;
+    long total;
+    char *used;
+
+
+    /* Time the hash function over every word. */
+
+    sum = 0;
+    start = now();
+
+    for (r = 0; r < ROUNDS; r ++)
+        for (i = 0; i < n; i ++)
+            sum += hash(words[i]);
+
+    elapsed = now() - start;
+    printf("%-12s %8.2f ns/word %8.1f MB/s   (checksum %08x)\n", name,
+           (double) elapsed / ROUNDS / n,
+           (double) bytes * ROUNDS / elapsed * 1000, sum);
+
+
+    /* Insert the distinct words into a table at most half full. */
+
+    for (length = 16; length < 2 * m; length *= 2)
+        ;
+
+    used = calloc(length, 1);
+    assert(used != NULL);
+    mask = length - 1;
+    memset(counts, 0, sizeof(counts));
+    total = max = 0;
+
+    for (i = 0; i < m; i ++) {
+        idx = hash(distinct[i]) & mask;
+
+        for (probes = 1; used[idx]; probes ++)
+            idx = (idx + 1) & mask;
+
+        used[idx] = 1;
+        total += probes;
+        if (probes > max)
+            max = probes;
+
+        for (r = 0; r < BUCKETS - 1 && probes > 1 << r; r ++)
+            ;
+        counts[r] ++;
+    }
+
+    printf("%-12s mean probes %.2f, max %d:", "", (double) total / m, max);
+
+    for (r = 0; r < BUCKETS; r ++)
+        printf(" %s=%.1f%%", labels[r], 100.0 * counts[r] / m);
+
+    printf("\n");
+    free(used);
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    FILE *fp;
+    char buffer[BUFSIZ], **words, **distinct, **slot;
+    int i, n, length;
+    long bytes;
+    SET *sp;
+
+
+    /* Check usage and read the words from each file. */
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s file...\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    length = 1024;
+    words = malloc(sizeof(char *) * length);
+    assert(words != NULL);
+    sp = createSet(0, strcmp, hashString);
+    n = bytes = 0;
+
+    for (i = 1; i < argc; i ++) {
+        if ((fp = fopen(argv[i], "r")) == NULL) {
+            fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[i]);
+            exit(EXIT_FAILURE);
+        }
+
+        while (fscanf(fp, "%s", buffer) == 1) {
+            slot = (char **) findOrAddElement(sp, buffer);
+
+            if (*slot == buffer)
+                *slot = strdup(buffer);
+
+            if (n == length) {
+                length *= 2;
+                words = realloc(words, sizeof(char *) * length);
+                assert(words != NULL);
+            }
+
+            words[n ++] = *slot;
+            bytes += strlen(buffer);
+        }
+
+        fclose(fp);
+    }
+
+    if (n == 0) {
+        fprintf(stderr, "%s: no words\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+
+    /* Compare the two hash functions. */
+
+    distinct = getElements(sp);
+    printf("%d words, %d distinct, %ld bytes\n", n, numElements(sp), bytes);
+    report("strhash", strhash, words, n, bytes, distinct, numElements(sp));
+    report("hashString", hashString, words, n, bytes, distinct, numElements(sp));
+
+    for (i = 0; i < numElements(sp); i ++)
+        free(distinct[i]);
+
+    free(distinct);
+    free(words);
+    destroySet(sp);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,108 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include "hll.h"
+
+#define MIN_PRECISION 4
+#define MAX_PRECISION 16
+
+struct hll
+{
+	uint8_t *registers;
+	int precision;
+	int count;
+	unsigned (*hash)();
+};
+
+static unsigned mix(unsigned hash);
+
+
+// Creates and allocates memory to the HyperLogLog, which is an array of 2^precision registers of one byte each, all zero. The relative error of the estimate is about 1.04/sqrt(2^precision), so each step of precision halves the error for twice the memory
+// O(2^precision)
+HLL *createHLL(int precision, unsigned (*hash)())
+{
+	HLL *hp=malloc(sizeof(HLL));
+	assert(hp!=NULL && hash!=NULL && precision>=MIN_PRECISION && precision<=MAX_PRECISION);
+	hp->precision=precision;
+	hp->count=1<<precision;
+	hp->hash=hash;
+	hp->registers=calloc(hp->count, sizeof(uint8_t));
+	assert(hp->registers!=NULL);
+	return hp;
+}
+
+// Frees up the memory allocated to the HyperLogLog
+// O(1)
+void destroyHLL(HLL *hp)
+{
+	assert(hp!=NULL);
+	free(hp->registers);
+	free(hp);
+}
+
+// Adds the element to the HyperLogLog. The high bits of the mixed hash value pick a register, and the register keeps the largest rank seen, which is one more than the number of leading zeros of the rest of the bits. The elements with a rank of r are about one in 2^r of those added to the register, so the ranks give away how many distinct elements there are without keeping them
+// O(1)
+void addToHLL(HLL *hp, void *elt)
+{
+	assert(hp!=NULL && elt!=NULL);
+	unsigned hash=mix((*hp->hash)(elt)), rest;
+	int idx, rank;
+	idx=hash>>(32-hp->precision);
+	rest=hash<<hp->precision;
+	rank=rest==0 ? 32-hp->precision+1 : __builtin_clz(rest)+1;
+	if(hp->registers[idx]<rank)
+		hp->registers[idx]=rank;
+}
+
+// Merges the other HyperLogLog into this one by keeping the larger of each pair of registers, which leaves the registers that the union of their elements would have given. Both must have the same precision and hash function
+// O(2^precision)
+void mergeHLL(HLL *hp, HLL *other)
+{
+	assert(hp!=NULL && other!=NULL && hp->precision==other->precision && hp->hash==other->hash);
+	int i;
+	for(i=0;i<hp->count;i++)
+		if(hp->registers[i]<other->registers[i])
+			hp->registers[i]=other->registers[i];
+}
+
+// Returns the estimate of the number of distinct elements, which is the harmonic mean of 2^rank over the registers, scaled by the number of registers and a constant that removes the bias. A small estimate is taken from the number of registers that are still zero instead, as linear counting does, and a large one is corrected for the collisions of 32-bit hash values
+// O(2^precision)
+double estimateDistinct(HLL *hp)
+{
+	assert(hp!=NULL);
+	int i, zeros=0;
+	double m=hp->count, sum=0, alpha, estimate;
+	for(i=0;i<hp->count;i++)
+	{
+		sum+=1.0/((uint64_t)1<<hp->registers[i]);
+		if(hp->registers[i]==0)
+			zeros++;
+	}
+	if(hp->count==16)
+		alpha=0.673;
+	else if(hp->count==32)
+		alpha=0.697;
+	else if(hp->count==64)
+		alpha=0.709;
+	else
+		alpha=0.7213/(1+1.079/m);
+	estimate=alpha*m*m/sum;
+	if(estimate<=2.5*m && zeros>0)
+		estimate=m*log(m/zeros);
+	else if(estimate>4294967296.0/30 && estimate<4294967296.0)
+		estimate=-4294967296.0*log(1-estimate/4294967296.0);
+	return estimate;
+}
+
+// Mixes the bits of the hash value given by the interface, since the high bits pick a register and the low bits give its rank; This is the finalizer of MurmurHash3
+// O(1)
+static unsigned mix(unsigned hash)
+{
+	hash^=hash>>16;
+	hash*=0x85ebca6b;
+	hash^=hash>>13;
+	hash*=0xc2b2ae35;
+	hash^=hash>>16;
+	return hash;
+}
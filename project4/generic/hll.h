@@ -0,0 +1,30 @@
+/*
+ * File:        hll.h
+ *
+ * Description: This file contains the public function and type
+ *              declarations for a HyperLogLog of generic pointer types.
+ *              A HyperLogLog estimates how many distinct elements have
+ *              been added to it in a fixed amount of memory, however many
+ *              there are, and adding an element again changes nothing.
+ *              The elements themselves are not kept, so only their hash
+ *              values are needed.  Two HyperLogLogs with the same
+ *              precision and hash function can be merged, after which the
+ *              estimate is that of the union of their elements.
+ */
+
+# ifndef HLL_H
+# define HLL_H
+
+typedef struct hll HLL;
+
+HLL *createHLL(int precision, unsigned (*hash)());
+
+void destroyHLL(HLL *hp);
+
+void addToHLL(HLL *hp, void *elt);
+
+void mergeHLL(HLL *hp, HLL *other);
+
+double estimateDistinct(HLL *hp);
+
+# endif /* HLL_H */
@@ -0,0 +1,196 @@
+/*
+ * File:        latbench.c
+ *
+ * Description: This file contains a benchmark for the latency of single
+ *              lookups in a set.  It is linked with table.c as latbench
+ *              and with cuckoo.c as clatbench, so the two can be compared
+ *              on the same input.
+ *
+ *              The program takes a file as a command line argument.  The
+ *              words of the file are inserted into a set, and then each
+ *              distinct word and a copy of it with a character appended,
+ *              which is not in the set, are looked up in a random order.
+ *              Every lookup is timed on its own, and the percentiles of
+ *              the latencies of the successful and unsuccessful lookups
+ *              are printed in nanoseconds.  The latencies include the
+ *              overhead of reading the clock.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <time.h>
+# include <assert.h>
+# include "set.h"
+# include "words.h"
+
+
+# define ROUNDS 5
+# define PERCENTILES 5
+
+
+/*
+ * Function:    now
+ *
+ * Description: Return the current time in nanoseconds.
+ */
+
+static long long now(void)
+{
+    struct timespec ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+/*
+ * Function:    compareTimes
+ *
+ * Description: Compare two latencies for qsort.
+ */
+
+static int compareTimes(const void *p1, const void *p2)
+{
+    long long t1 = *(long long *) p1, t2 = *(long long *) p2;
+
+
+    return t1 < t2 ? -1 : t1 > t2;
+}
+
+
+/*
+ * Function:    report
+ *
+ * Description: Sort the N latencies in TIMES and print their mean,
+ *              percentiles, and maximum.
+ */
+
+static void report(char *name, long long *times, int n)
+{
+    static double levels[PERCENTILES] = {50, 90, 99, 99.9, 99.99};
+    long long sum = 0;
+    int i;
+
+
+    qsort(times, n, sizeof(long long), compareTimes);
+
+    for (i = 0; i < n; i ++)
+	sum += times[i];
+
+    printf("%-8s %8.1f", name, (double) sum / n);
+
+    for (i = 0; i < PERCENTILES; i ++)
+	printf(" %8lld", times[(int) (n * levels[i] / 100)]);
+
+    printf(" %8lld\n", times[n - 1]);
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    WORDS *wp;
+    SET *sp;
+    char *word, **slot, **words, **keys, *tmp;
+    long long start, *hits, *misses;
+    int i, j, k, n, h, m, length;
+
+
+    /* Check usage and insert the words of the file. */
+
+    if (argc != 2) {
+	fprintf(stderr, "usage: %s file\n", argv[0]);
+	exit(EXIT_FAILURE);
+    }
+
+    if ((wp = openWords(argv[1])) == NULL) {
+	fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
+	exit(EXIT_FAILURE);
+    }
+
+    sp = createSet(0, strcmp, hashString);
+
+    while ((word = nextWord(wp, &length)) != NULL) {
+	word = termWord(wp, word, length);
+	slot = (char **) findOrAddElement(sp, word);
+
+	if (*slot == word)
+	    *slot = keepWord(wp, word, length);
+    }
+
+
+    /* Make a key that is not in the set for each word that is, and
+       shuffle all of the keys together. */
+
+    n = numElements(sp);
+    words = getElements(sp);
+    keys = malloc(sizeof(char *) * n * 2);
+    assert(keys != NULL);
+
+    for (i = 0; i < n; i ++) {
+	length = strlen(words[i]);
+	keys[i] = words[i];
+	keys[n + i] = malloc(length + 2);
+	assert(keys[n + i] != NULL);
+
+	memcpy(keys[n + i], words[i], length);
+	strcpy(keys[n + i] + length, "#");
+    }
+
+    srand(1);
+
+    for (i = n * 2 - 1; i > 0; i --) {
+	j = rand() % (i + 1);
+	tmp = keys[i];
+	keys[i] = keys[j];
+	keys[j] = tmp;
+    }
+
+
+    /* Time each lookup on its own. */
+
+    hits = malloc(sizeof(long long) * n * ROUNDS);
+    misses = malloc(sizeof(long long) * n * ROUNDS);
+    assert(hits != NULL && misses != NULL);
+    h = m = 0;
+
+    for (k = 0; k < ROUNDS; k ++)
+	for (i = 0; i < n * 2; i ++) {
+	    start = now();
+	    tmp = findElement(sp, keys[i]);
+	    start = now() - start;
+
+	    if (tmp != NULL) {
+		assert(tmp == keys[i]);
+		hits[h ++] = start;
+	    } else
+		misses[m ++] = start;
+	}
+
+    assert(h == n * ROUNDS && m == n * ROUNDS);
+
+    printf("%d distinct words, %d lookups of each kind\n", n, h);
+    printf("%-8s %8s %8s %8s %8s %8s %8s %8s\n", "lookup", "mean", "p50",
+	   "p90", "p99", "p99.9", "p99.99", "max");
+    report("hit", hits, h);
+    report("miss", misses, m);
+
+    for (i = 0; i < n * 2; i ++)
+	if (findElement(sp, keys[i]) == NULL)
+	    free(keys[i]);
+
+    free(keys);
+    free(words);
+    free(hits);
+    free(misses);
+    destroySet(sp);
+    closeWords(wp);
+    exit(EXIT_SUCCESS);
+}
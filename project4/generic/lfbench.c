@@ -0,0 +1,395 @@
+/*
+ * File:        lfbench.c
+ *
+ * Description: This file contains a stress test and a benchmark for the
+ *              lock-free set abstract data type.
+ *
+ *              The program takes a file and an optional maximum number of
+ *              threads as command line arguments, and uses the distinct
+ *              words of the file as keys.  First, the lock-free set is
+ *              checked with every thread adding, finding, and removing the
+ *              same keys at once: exactly one thread must succeed in adding
+ *              or removing each key, and the threads that work on their own
+ *              keys must always see the results of their own operations.
+ *              Then, for each number of threads from one up to the
+ *              maximum, a read-mostly mix of operations is timed on the
+ *              lock-free set and on the set of table.c behind one mutex.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <time.h>
+# include <assert.h>
+# include <pthread.h>
+# include "set.h"
+# include "lfset.h"
+
+
+# define DEFAULT_THREADS 8
+# define OPERATIONS 4000000
+# define FINDS 90
+
+struct worker {
+    int id, threads;
+    LFSET *lp;
+    SET *sp;
+    pthread_mutex_t *lock;
+    char **keys;
+    int n, ops, successes;
+    unsigned seed;
+};
+
+
+/*
+ * Function:    random32
+ *
+ * Description: Return the next pseudo-random number of a worker.
+ */
+
+static unsigned random32(struct worker *wp)
+{
+    wp->seed ^= wp->seed << 13;
+    wp->seed ^= wp->seed >> 17;
+    wp->seed ^= wp->seed << 5;
+    return wp->seed;
+}
+
+
+/*
+ * Function:    addAll
+ *
+ * Description: Thread function that tries to add every key, starting at
+ *              a different key in each thread, and counts its successes.
+ */
+
+static void *addAll(void *arg)
+{
+    struct worker *wp = arg;
+    int i, start;
+
+
+    start = (long) wp->n * wp->id / wp->threads;
+
+    for (i = 0; i < wp->n; i ++)
+        if (addLFElement(wp->lp, wp->keys[(start + i) % wp->n]))
+            wp->successes ++;
+
+    return NULL;
+}
+
+
+/*
+ * Function:    removeAll
+ *
+ * Description: Thread function that tries to remove every key, starting at
+ *              a different key in each thread, and counts its successes.
+ */
+
+static void *removeAll(void *arg)
+{
+    struct worker *wp = arg;
+    int i, start;
+
+
+    start = (long) wp->n * wp->id / wp->threads;
+
+    for (i = 0; i < wp->n; i ++)
+        if (removeLFElement(wp->lp, wp->keys[(start + i) % wp->n]))
+            wp->successes ++;
+
+    return NULL;
+}
+
+
+/*
+ * Function:    churn
+ *
+ * Description: Thread function that adds, removes, and finds random keys.
+ *              A worker changes only the keys whose index modulo the
+ *              number of threads is its own id, and keeps track of which
+ *              of them it expects to be present, but it also looks up the
+ *              keys of the other workers.
+ */
+
+static void *churn(void *arg)
+{
+    struct worker *wp = arg;
+    char *key, *present, *found;
+    int i, k, mine, r, result;
+
+
+    mine = (wp->n - wp->id + wp->threads - 1) / wp->threads;
+    present = calloc(mine, 1);
+    assert(present != NULL);
+
+    for (i = 0; i < wp->ops; i ++) {
+        k = random32(wp) % mine;
+        key = wp->keys[k * wp->threads + wp->id];
+        r = random32(wp) % 3;
+
+        if (r == 0) {
+            result = addLFElement(wp->lp, key);
+            assert(result == !present[k]);
+            present[k] = 1;
+        } else if (r == 1) {
+            result = removeLFElement(wp->lp, key);
+            assert(result == present[k]);
+            present[k] = 0;
+        } else {
+            found = findLFElement(wp->lp, key);
+            assert(found == (present[k] ? key : NULL));
+        }
+
+        k = random32(wp) % wp->n;
+        found = findLFElement(wp->lp, wp->keys[k]);
+        assert(found == NULL || found == wp->keys[k]);
+    }
+
+    for (k = 0; k < mine; k ++)
+        wp->successes += present[k];
+
+    free(present);
+    return NULL;
+}
+
+
+/*
+ * Function:    mixLockFree
+ *
+ * Description: Thread function that runs a read-mostly mix of operations
+ *              on the lock-free set.
+ */
+
+static void *mixLockFree(void *arg)
+{
+    struct worker *wp = arg;
+    int i, r;
+    char *key;
+
+
+    for (i = 0; i < wp->ops; i ++) {
+        key = wp->keys[random32(wp) % wp->n];
+        r = random32(wp) % 100;
+
+        if (r < FINDS)
+            wp->successes += findLFElement(wp->lp, key) != NULL;
+        else if (r % 2 == 0)
+            addLFElement(wp->lp, key);
+        else
+            removeLFElement(wp->lp, key);
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Function:    mixLocked
+ *
+ * Description: Thread function that runs the same mix of operations on the
+ *              set of table.c while holding a single mutex.
+ */
+
+static void *mixLocked(void *arg)
+{
+    struct worker *wp = arg;
+    int i, r;
+    char *key;
+
+
+    for (i = 0; i < wp->ops; i ++) {
+        key = wp->keys[random32(wp) % wp->n];
+        r = random32(wp) % 100;
+        pthread_mutex_lock(wp->lock);
+
+        if (r < FINDS)
+            wp->successes += findElement(wp->sp, key) != NULL;
+        else if (r % 2 == 0) {
+            if (findElement(wp->sp, key) == NULL)
+                addElement(wp->sp, key);
+        } else
+            removeElement(wp->sp, key);
+
+        pthread_mutex_unlock(wp->lock);
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Function:    run
+ *
+ * Description: Run the thread function FUNC in T threads and return the
+ *              total number of successes of the workers.
+ */
+
+static int run(void *(*func)(void *), struct worker *workers,
+               pthread_t *threads, int t)
+{
+    int i, total;
+
+
+    for (i = 0; i < t; i ++) {
+        workers[i].id = i;
+        workers[i].threads = t;
+        workers[i].successes = 0;
+        workers[i].seed = 2463534242u + i;
+        pthread_create(&threads[i], NULL, func, &workers[i]);
+    }
+
+    for (i = total = 0; i < t; i ++) {
+        pthread_join(threads[i], NULL);
+        total += workers[i].successes;
+    }
+
+    return total;
+}
+
+
+/*
+ * Function:    now
+ *
+ * Description: Return the current time in nanoseconds.
+ */
+
+static long long now(void)
+{
+    struct timespec ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the stress test and the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    FILE *fp;
+    char buffer[BUFSIZ], **keys, **slot;
+    int i, t, n, total, maxThreads;
+    struct worker *workers;
+    pthread_t *threads;
+    pthread_mutex_t lock;
+    long long start, lockFree, locked;
+    LFSET *lp;
+    SET *sp;
+
+
+    /* Check usage and read the distinct words. */
+
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "usage: %s file [threads]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if ((fp = fopen(argv[1], "r")) == NULL) {
+        fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
+        exit(EXIT_FAILURE);
+    }
+
+    maxThreads = argc == 3 ? atoi(argv[2]) : DEFAULT_THREADS;
+    assert(maxThreads > 0);
+
+    sp = createSet(0, strcmp, hashString);
+
+    while (fscanf(fp, "%s", buffer) == 1) {
+        slot = (char **) findOrAddElement(sp, buffer);
+
+        if (*slot == buffer)
+            *slot = strdup(buffer);
+    }
+
+    fclose(fp);
+    n = numElements(sp);
+    keys = getElements(sp);
+    destroySet(sp);
+
+    if (n < maxThreads) {
+        fprintf(stderr, "%s: too few distinct words\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    threads = malloc(sizeof(pthread_t) * maxThreads);
+    workers = malloc(sizeof(struct worker) * maxThreads);
+    assert(threads != NULL && workers != NULL);
+    pthread_mutex_init(&lock, NULL);
+
+    for (i = 0; i < maxThreads; i ++) {
+        workers[i].keys = keys;
+        workers[i].n = n;
+        workers[i].lock = &lock;
+    }
+
+
+    /* Stress the lock-free set, starting small so that it must grow. */
+
+    lp = createLFSet(0, strcmp, hashString);
+
+    for (i = 0; i < maxThreads; i ++) {
+        workers[i].lp = lp;
+        workers[i].ops = OPERATIONS / maxThreads;
+    }
+
+    total = run(addAll, workers, threads, maxThreads);
+    assert(total == n && numLFElements(lp) == n);
+
+    total = run(removeAll, workers, threads, maxThreads);
+    assert(total == n && numLFElements(lp) == 0);
+
+    total = run(churn, workers, threads, maxThreads);
+    assert(total == numLFElements(lp));
+    destroyLFSet(lp);
+    printf("%d keys, stress test passed with %d threads\n", n, maxThreads);
+
+
+    /* Time the read-mostly mix on both sets. */
+
+    printf("%8s %14s %14s\n", "threads", "lock-free Mops", "mutex Mops");
+
+    for (t = 1; t <= maxThreads; t ++) {
+        lp = createLFSet(0, strcmp, hashString);
+        sp = createSet(0, strcmp, hashString);
+
+        for (i = 0; i < n; i += 2) {
+            addLFElement(lp, keys[i]);
+            addElement(sp, keys[i]);
+        }
+
+        for (i = 0; i < t; i ++) {
+            workers[i].lp = lp;
+            workers[i].sp = sp;
+            workers[i].ops = OPERATIONS / t;
+        }
+
+        start = now();
+        run(mixLockFree, workers, threads, t);
+        lockFree = now() - start;
+
+        start = now();
+        run(mixLocked, workers, threads, t);
+        locked = now() - start;
+
+        printf("%8d %14.2f %14.2f\n", t, OPERATIONS / (lockFree / 1e3),
+               OPERATIONS / (locked / 1e3));
+
+        destroyLFSet(lp);
+        destroySet(sp);
+    }
+
+    for (i = 0; i < n; i ++)
+        free(keys[i]);
+
+    free(keys);
+    free(workers);
+    free(threads);
+    pthread_mutex_destroy(&lock);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,384 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "lfset.h"
+
+#define NEW 0
+#define PRESENT 1
+#define ABSENT 2
+#define MOVED 4
+
+#define LOOKUP 0
+#define INSERT 1
+#define COPY 2
+
+#define FOUND 0
+#define CLAIMED 1
+#define MISSING 2
+#define FULL 3
+#define SEALED 4
+
+#define MIN_LENGTH 16
+#define MAX_LOAD(n) ((n)/4*3)
+#define MIGRATE_SLOTS 64
+#define REBUILD_LENGTH 1024
+
+struct slot
+{
+	_Atomic(void *) key;
+	atomic_uint hash;
+	atomic_int state;
+};
+
+struct table
+{
+	struct slot *slots;
+	int length;
+	atomic_int claimed;
+	atomic_int chunk;
+	atomic_int copied;
+	_Atomic(struct table *) next;
+};
+
+struct lfset
+{
+	_Atomic(struct table *) top;
+	struct table *first;
+	atomic_int count;
+	int (*compare)();
+	unsigned (*hash)();
+};
+
+static char seal;
+
+static struct table *newTable(int length);
+static int probe(LFSET *lp, struct table *tp, void *elt, unsigned hash, int mode, int *idx);
+static void copySlot(LFSET *lp, struct table *tp, int idx);
+static void moveSlot(LFSET *lp, struct table *tp, int idx);
+static void migrate(LFSET *lp, struct table *tp, bool finish);
+static void resize(LFSET *lp, struct table *tp);
+static unsigned mix(unsigned hash);
+
+
+// Creates and allocates memory to the set. As in table.c, maxElts is only a hint, since the set grows by itself
+// O(n)
+LFSET *createLFSet(int maxElts, int (*compare)(), unsigned (*hash)())
+{
+	int length=MIN_LENGTH;
+	LFSET *lp=malloc(sizeof(LFSET));
+	assert(lp!=NULL && compare!=NULL && hash!=NULL);
+	while(MAX_LOAD(length)<maxElts)
+		length*=2;
+	lp->first=newTable(length);
+	atomic_init(&lp->top, lp->first);
+	atomic_init(&lp->count, 0);
+	lp->compare=compare;
+	lp->hash=hash;
+	return lp;
+}
+
+// Frees up the memory allocated to the set; Every table that the set has ever used is still linked from the first one, since a thread may still be reading an old table while the set is in use. The set must no longer be in use by any thread
+// O(n)
+void destroyLFSet(LFSET *lp)
+{
+	assert(lp!=NULL);
+	struct table *tp, *np;
+	for(tp=lp->first;tp!=NULL;tp=np)
+	{
+		np=atomic_load(&tp->next);
+		free(tp->slots);
+		free(tp);
+	}
+	free(lp);
+}
+
+// Returns the number of elements in the set; While other threads are changing the set, the result is only a snapshot
+// O(1)
+int numLFElements(LFSET *lp)
+{
+	assert(lp!=NULL);
+	return atomic_load(&lp->count);
+}
+
+// Adds the element to the set if no equal element is present, and returns 1 if it was added or 0 if it was already present. A new key is claimed by a compare-and-swap of an empty slot from NULL to elt, and is then published by a compare-and-swap of the state of the slot to PRESENT, which is the point at which the element becomes visible. New keys are only claimed in the newest table once a migration has finished, so a thread that needs to claim one while a migration is pending finishes the migration first, together with any other threads doing the same
+// O(1) expected
+int addLFElement(LFSET *lp, void *elt)
+{
+	assert(lp!=NULL && elt!=NULL);
+	int idx, r, state;
+	struct slot *sp;
+	struct table *tp, *top;
+	unsigned hash=mix((*lp->hash)(elt));
+	tp=atomic_load(&lp->top);
+	if(atomic_load(&tp->next)!=NULL)
+		migrate(lp, tp, false);
+	for(;;)
+	{
+		top=atomic_load(&lp->top);
+		if(tp==top && atomic_load(&tp->next)==NULL)
+			r=probe(lp, tp, elt, hash, INSERT, &idx);
+		else
+			r=probe(lp, tp, elt, hash, LOOKUP, &idx);
+		if(r==FOUND || r==CLAIMED)
+		{
+			sp=&tp->slots[idx];
+			state=atomic_load(&sp->state);
+			while(!(state&MOVED))
+			{
+				if(state==PRESENT)
+					return 0;
+				if(atomic_compare_exchange_weak(&sp->state, &state, PRESENT))
+				{
+					atomic_fetch_add(&lp->count, 1);
+					return 1;
+				}
+			}
+			copySlot(lp, tp, idx);
+			tp=atomic_load(&tp->next);
+		}
+		else if(r==SEALED)
+			tp=atomic_load(&tp->next);
+		else if(r==FULL)
+		{
+			resize(lp, tp);
+			migrate(lp, tp, true);
+			tp=atomic_load(&lp->top);
+		}
+		else
+		{
+			if(atomic_load(&top->next)!=NULL)
+				migrate(lp, top, true);
+			tp=atomic_load(&lp->top);
+		}
+	}
+}
+
+// Removes the element matching elt from the set, and returns 1 if it was removed or 0 if it was not present. The key stays in its slot and only the state of the slot is changed from PRESENT to ABSENT, so that no probe sequence is ever broken and the key can be added again in the same slot
+// O(1) expected
+int removeLFElement(LFSET *lp, void *elt)
+{
+	assert(lp!=NULL && elt!=NULL);
+	int idx, r, state;
+	struct slot *sp;
+	struct table *tp;
+	unsigned hash=mix((*lp->hash)(elt));
+	tp=atomic_load(&lp->top);
+	if(atomic_load(&tp->next)!=NULL)
+		migrate(lp, tp, false);
+	for(;;)
+	{
+		r=probe(lp, tp, elt, hash, LOOKUP, &idx);
+		if(r==MISSING)
+			return 0;
+		if(r==FOUND)
+		{
+			sp=&tp->slots[idx];
+			state=atomic_load(&sp->state);
+			while(!(state&MOVED))
+			{
+				if(state!=PRESENT)
+					return 0;
+				if(atomic_compare_exchange_weak(&sp->state, &state, ABSENT))
+				{
+					atomic_fetch_sub(&lp->count, 1);
+					return 1;
+				}
+			}
+			copySlot(lp, tp, idx);
+		}
+		tp=atomic_load(&tp->next);
+	}
+}
+
+// Finds the element matching elt and returns the element stored in the set, or NULL if it is not present. A lookup never waits for another thread: if the slot of the element has been marked as MOVED by a migration, the lookup copies that one slot itself if needed and continues in the next table
+// O(1) expected
+void *findLFElement(LFSET *lp, void *elt)
+{
+	assert(lp!=NULL && elt!=NULL);
+	int idx, r, state;
+	struct table *tp;
+	unsigned hash=mix((*lp->hash)(elt));
+	tp=atomic_load(&lp->top);
+	for(;;)
+	{
+		r=probe(lp, tp, elt, hash, LOOKUP, &idx);
+		if(r==MISSING)
+			return NULL;
+		if(r==FOUND)
+		{
+			state=atomic_load(&tp->slots[idx].state);
+			if(!(state&MOVED))
+				return state==PRESENT ? atomic_load(&tp->slots[idx].key) : NULL;
+			copySlot(lp, tp, idx);
+		}
+		tp=atomic_load(&tp->next);
+	}
+}
+
+// Allocates memory to a new array that holds the elements of the set; It must not be called while other threads are changing the set, and finishes any migration that is still pending
+// O(n)
+void *getLFElements(LFSET *lp)
+{
+	assert(lp!=NULL);
+	int i, count=0;
+	struct table *tp=atomic_load(&lp->top);
+	void **temp=malloc(sizeof(void*)*atomic_load(&lp->count));
+	assert(temp!=NULL);
+	if(atomic_load(&tp->next)!=NULL)
+	{
+		migrate(lp, tp, true);
+		tp=atomic_load(&lp->top);
+	}
+	for(i=0;i<tp->length;i++)
+		if(atomic_load(&tp->slots[i].state)==PRESENT)
+			temp[count++]=atomic_load(&tp->slots[i].key);
+	assert(count==atomic_load(&lp->count));
+	return temp;
+}
+
+// Allocates a table with the given length, which must be a power of two; Every slot starts with a NULL key and the NEW state, which are both zero, so the slots are allocated with calloc
+// O(1)
+static struct table *newTable(int length)
+{
+	struct table *tp=malloc(sizeof(struct table));
+	assert(tp!=NULL);
+	tp->slots=calloc(length, sizeof(struct slot));
+	assert(tp->slots!=NULL);
+	tp->length=length;
+	atomic_init(&tp->claimed, 0);
+	atomic_init(&tp->chunk, 0);
+	atomic_init(&tp->copied, 0);
+	atomic_init(&tp->next, NULL);
+	return tp;
+}
+
+// Probes the table pointed to by tp for the key matching elt by linear probing from its home slot, and sets *idx to its slot if it is FOUND. The stored hash value is checked before the compare function is called; it is zero only while the thread that claimed the slot has not stored it yet, in which case the key is compared anyway and the hash value is stored on its behalf, so that a slot found by another thread and published by it never lacks its hash value when it is later copied. A NULL key ends the probe, since keys are never taken out of their slots: a LOOKUP reports the key as MISSING, while an INSERT or a COPY tries to claim the slot for elt and looks at the same slot again if another thread claims it first. An INSERT gives up with FULL once the table has reached its maximum load factor, which a COPY ignores. A SEALED slot was empty when the table was migrated, so the key can only be in the next table, and the same holds for a table with no empty slot left once it has a next table
+// O(1) expected
+static int probe(LFSET *lp, struct table *tp, void *elt, unsigned hash, int mode, int *idx)
+{
+	int i, n;
+	void *key;
+	unsigned stored, mask=tp->length-1;
+	struct slot *sp;
+	for(i=hash&mask, n=0;n<tp->length;i=(i+1)&mask, n++)
+	{
+		sp=&tp->slots[i];
+		key=atomic_load(&sp->key);
+		if(key==NULL)
+		{
+			if(mode==LOOKUP)
+				return MISSING;
+			if(mode==INSERT && atomic_load(&tp->claimed)>=MAX_LOAD(tp->length))
+				return FULL;
+			if(atomic_compare_exchange_strong(&sp->key, &key, elt))
+			{
+				atomic_store(&sp->hash, hash);
+				atomic_fetch_add(&tp->claimed, 1);
+				*idx=i;
+				return CLAIMED;
+			}
+		}
+		if(key==&seal)
+			return SEALED;
+		stored=atomic_load(&sp->hash);
+		if((stored==hash || stored==0) && (key==elt || (*lp->compare)(key, elt)==0))
+		{
+			if(stored==0)
+				atomic_store(&sp->hash, hash);
+			*idx=i;
+			return FOUND;
+		}
+	}
+	if(mode!=LOOKUP)
+		return FULL;
+	return atomic_load(&tp->next)!=NULL ? SEALED : MISSING;
+}
+
+// Copies slot idx of the table pointed to by tp into the next table. The MOVED bit is first set in the state of the slot, which freezes it, since every state change is a compare-and-swap that fails once the bit is set. If the key was PRESENT, it is then added to the next table with a compare-and-swap of its state from NEW to PRESENT. Copying is idempotent, so any number of threads may copy the same slot: once the key is in the next table, any later change to it there has already moved its state away from NEW, and a late copy cannot bring it back
+// O(1) expected
+static void copySlot(LFSET *lp, struct table *tp, int idx)
+{
+	int j, r, expected=NEW;
+	struct slot *sp=&tp->slots[idx];
+	struct table *np=atomic_load(&tp->next);
+	int state=atomic_load(&sp->state);
+	while(!(state&MOVED) && !atomic_compare_exchange_weak(&sp->state, &state, state|MOVED))
+		;
+	if((state&~MOVED)!=PRESENT)
+		return;
+	r=probe(lp, np, atomic_load(&sp->key), atomic_load(&sp->hash), COPY, &j);
+	assert(r==FOUND || r==CLAIMED);
+	atomic_compare_exchange_strong(&np->slots[j].state, &expected, PRESENT);
+}
+
+// Migrates slot idx of the table pointed to by tp; An empty slot is sealed with a compare-and-swap so that no key can be claimed in it afterwards, and any other slot is copied
+// O(1) expected
+static void moveSlot(LFSET *lp, struct table *tp, int idx)
+{
+	void *key=NULL;
+	struct slot *sp=&tp->slots[idx];
+	if(atomic_compare_exchange_strong(&sp->key, &key, (void *)&seal))
+		return;
+	if(key!=&seal)
+		copySlot(lp, tp, idx);
+}
+
+// Migrates the table pointed to by tp into its next table. Threads claim chunks of MIGRATE_SLOTS slots with a fetch-and-add, so that any number of threads can migrate the table in parallel. A thread that is only helping out migrates one chunk. A thread that must see the migration finished goes on until every chunk has been claimed, and then, if other threads are still copying their chunks, moves every slot itself instead of waiting for them, which is safe since moving a slot is idempotent. The thread that sees the last slot migrated makes the next table the top table of the set
+// O(n) to finish, O(MIGRATE_SLOTS) to help
+static void migrate(LFSET *lp, struct table *tp, bool finish)
+{
+	int i, start, end;
+	struct table *expected=tp;
+	while(atomic_load(&tp->copied)<tp->length)
+	{
+		start=atomic_fetch_add(&tp->chunk, MIGRATE_SLOTS);
+		if(start>=tp->length)
+		{
+			if(finish==false)
+				return;
+			for(i=0;i<tp->length;i++)
+				moveSlot(lp, tp, i);
+			atomic_store(&tp->copied, tp->length);
+			break;
+		}
+		end=start+MIGRATE_SLOTS<tp->length ? start+MIGRATE_SLOTS : tp->length;
+		for(i=start;i<end;i++)
+			moveSlot(lp, tp, i);
+		atomic_fetch_add(&tp->copied, end-start);
+		if(finish==false)
+			break;
+	}
+	if(atomic_load(&tp->copied)>=tp->length)
+		atomic_compare_exchange_strong(&lp->top, &expected, atomic_load(&tp->next));
+}
+
+// Starts a migration of the top table pointed to by tp by installing its next table with a compare-and-swap, so that only one of the threads that find the table full succeeds. As in table.c, the next table is twice as large unless few of the claimed slots are still PRESENT, in which case it keeps the same size and the migration only clears out the keys that were removed. The count can lag behind the table by an element or two per thread, so small tables always double, which leaves room for the copies unless there are hundreds of threads
+// O(n)
+static void resize(LFSET *lp, struct table *tp)
+{
+	int length=tp->length;
+	struct table *np, *expected=NULL;
+	if(atomic_load(&tp->next)!=NULL)
+		return;
+	if(length<REBUILD_LENGTH || atomic_load(&lp->count)>=length/4)
+		length*=2;
+	np=newTable(length);
+	if(!atomic_compare_exchange_strong(&tp->next, &expected, np))
+	{
+		free(np->slots);
+		free(np);
+	}
+}
+
+// Mixes the bits of the hash value given by the interface, since the low bits pick the home slot of a power-of-two table; This is the finalizer of MurmurHash3
+// O(1)
+static unsigned mix(unsigned hash)
+{
+	hash^=hash>>16;
+	hash*=0x85ebca6b;
+	hash^=hash>>13;
+	hash*=0xc2b2ae35;
+	hash^=hash>>16;
+	return hash;
+}
@@ -0,0 +1,32 @@
+/*
+ * File:        lfset.h
+ *
+ * Description: This file contains the public function and type
+ *              declarations for a lock-free set abstract data type for
+ *              generic pointer types.  The set may be used by several
+ *              threads at once, and no operation ever waits for a lock.
+ *              An element that has been added must stay valid until the
+ *              set is destroyed, even after it is removed, since its slot
+ *              keeps pointing to it.
+ */
+
+# ifndef LFSET_H
+# define LFSET_H
+
+typedef struct lfset LFSET;
+
+LFSET *createLFSet(int maxElts, int (*compare)(), unsigned (*hash)());
+
+void destroyLFSet(LFSET *lp);
+
+int numLFElements(LFSET *lp);
+
+int addLFElement(LFSET *lp, void *elt);
+
+int removeLFElement(LFSET *lp, void *elt);
+
+void *findLFElement(LFSET *lp, void *elt);
+
+void *getLFElements(LFSET *lp);
+
+# endif /* LFSET_H */
@@ -16,31 +16,14 @@
 # include <stdlib.h>
 # include <string.h>
 # include "set.h"
+# include "words.h"
 
 
-/* This is sufficient for the test cases in /scratch/coen12. */
+/* This is only an initial size hint; the set grows as needed. */
 
 # define MAX_SIZE 18000
 
 
-/*
- * Function:    strhash
- *
- * Description: Return a hash value for a string S.
- */
-
-static unsigned strhash(char *s)
-{
-    unsigned hash = 0;
-
-
-    while (*s != '\0')
-        hash = 31 * hash + *s ++;
-
-    return hash;
-}
-
-
 /*
  * Function:    main
  *
@@ -49,10 +32,10 @@ static unsigned strhash(char *s)
 
 int main(int argc, char *argv[])
 {
-    FILE *fp;
-    char buffer[BUFSIZ], *word;
+    WORDS *wp;
+    char *word, **slot;
     SET *odd;
-    int words;
+    int words, length;
 
 
     /* Check usage and open the file. */
@@ -62,31 +45,35 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
-    if ((fp = fopen(argv[1], "r")) == NULL) {
+    if ((wp = openWords(argv[1])) == NULL) {
         fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
         exit(EXIT_FAILURE);
     }
 
 
-    /* Insert or delete words to compute their parity. */
+    /* Insert or delete words to compute their parity.  Each word is
+       looked up as a temporary string, and only a word that is added is
+       kept as a copy. */
 
     words = 0;
-    odd = createSet(MAX_SIZE, strcmp, strhash);
+    odd = createSet(MAX_SIZE, strcmp, hashString);
 
-    while (fscanf(fp, "%s", buffer) == 1) {
+    while ((word = nextWord(wp, &length)) != NULL) {
         words ++;
 
-        if ((word = findElement(odd, buffer)) != NULL) {
-            removeElement(odd, buffer);
-	    free(word);
-	} else
-            addElement(odd, strdup(buffer));
+        word = termWord(wp, word, length);
+        slot = (char **) findOrAddElement(odd, word);
+
+        if (*slot != word)
+            removeSlot(odd, (void **) slot);
+        else
+            *slot = keepWord(wp, word, length);
     }
 
     printf("%d total words\n", words);
     printf("%d words occur an odd number of times\n", numElements(odd));
-    fclose(fp);
 
     destroySet(odd);
+    closeWords(wp);
     exit(EXIT_SUCCESS);
 }
@@ -0,0 +1,337 @@
+/*
+ * File:        probebench.c
+ *
+ * Description: This file contains a benchmark that compares the probe
+ *              sequences of table.c: linear probing, quadratic probing,
+ *              and double hashing.
+ *
+ *              The program takes any number of files as command line
+ *              arguments, and the distinct words of each file are used as
+ *              a set of keys.  Two synthetic sets of integer keys are
+ *              added, whose hash values are picked so that the hash values
+ *              that table.c mixes them into are adversarial.  The keys of
+ *              the first set all have the same home slot.  The keys of the
+ *              second set have consecutive home slots, so that they fill a
+ *              single run of the table.  For each set of keys and each
+ *              probe sequence, a set is timed inserting every key, looking
+ *              up every key, and looking up as many keys that are not in
+ *              the set, and the average probes to find and to miss are
+ *              taken from getSetStats.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <stdint.h>
+# include <time.h>
+# include <assert.h>
+# include "set.h"
+# include "words.h"
+
+
+# define ROUNDS 5
+# define SAME_HOME_KEYS 4096
+# define ONE_RUN_KEYS 16384
+# define MISS_BIT 0x80000000u
+
+
+/* The probe sequences, in the order they are printed. */
+
+static int probes[] = {0, SET_QUADRATIC, SET_DOUBLE};
+static char *names[] = {"linear", "quadratic", "double"};
+
+
+/*
+ * Function:    inverse
+ *
+ * Description: Return the multiplicative inverse of an odd number modulo
+ *              two to the 32nd power, by Newton's method.
+ */
+
+static unsigned inverse(unsigned x)
+{
+    unsigned y = x;
+    int i;
+
+
+    for (i = 0; i < 5; i ++)
+	y *= 2 - x * y;
+
+    return y;
+}
+
+
+/*
+ * Function:    unmix
+ *
+ * Description: Return the hash value that the finalizer of MurmurHash3,
+ *              which table.c applies to every hash value, maps to HASH.
+ *              Each step of the finalizer is undone in reverse order.
+ */
+
+static unsigned unmix(unsigned hash)
+{
+    hash ^= hash >> 16;
+    hash *= inverse(0xc2b2ae35);
+    hash ^= (hash >> 13) ^ (hash >> 26);
+    hash *= inverse(0x85ebca6b);
+    hash ^= hash >> 16;
+    return hash;
+}
+
+
+/*
+ * Function:    compareInts
+ *
+ * Description: Compare two integers stored as pointers.
+ */
+
+static int compareInts(void *p1, void *p2)
+{
+    intptr_t x = (intptr_t) p1, y = (intptr_t) p2;
+
+
+    return x < y ? -1 : x > y;
+}
+
+
+/*
+ * Function:    hashInt
+ *
+ * Description: Return an integer stored as a pointer as its own hash
+ *              value, since the integer keys are chosen by their hash
+ *              values.
+ */
+
+static unsigned hashInt(void *p)
+{
+    return (unsigned) (intptr_t) p;
+}
+
+
+/*
+ * Function:    now
+ *
+ * Description: Return the current time in nanoseconds.
+ */
+
+static long long now(void)
+{
+    struct timespec ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+/*
+ * Function:    shuffle
+ *
+ * Description: Shuffle an array of N pointers.
+ */
+
+static void shuffle(void **keys, int n)
+{
+    void *tmp;
+    int i, j;
+
+
+    for (i = n - 1; i > 0; i --) {
+	j = rand() % (i + 1);
+	tmp = keys[i];
+	keys[i] = keys[j];
+	keys[j] = tmp;
+    }
+}
+
+
+/*
+ * Function:    bench
+ *
+ * Description: Time a set with each probe sequence on the N keys in HITS
+ *              and the N keys in MISSES that are not among them, and
+ *              print a row for each.
+ */
+
+static void bench(char *name, void **hits, void **misses, int n,
+		  int (*compare)(), unsigned (*hash)())
+{
+    SET *sp;
+    STATS stats;
+    long long start, insert, found, missed;
+    int i, k, p;
+
+
+    for (p = 0; p < (int) (sizeof(probes) / sizeof(probes[0])); p ++) {
+	shuffle(hits, n);
+
+	start = now();
+	sp = createSetWith(0, compare, hash, probes[p]);
+
+	for (i = 0; i < n; i ++)
+	    addElement(sp, hits[i]);
+
+	insert = now() - start;
+	assert(numElements(sp) == n);
+	shuffle(hits, n);
+
+	start = now();
+
+	for (k = 0; k < ROUNDS; k ++)
+	    for (i = 0; i < n; i ++)
+		assert(findElement(sp, hits[i]) == hits[i]);
+
+	found = now() - start;
+
+	start = now();
+
+	for (k = 0; k < ROUNDS; k ++)
+	    for (i = 0; i < n; i ++)
+		assert(findElement(sp, misses[i]) == NULL);
+
+	missed = now() - start;
+
+	getSetStats(sp, &stats);
+	printf("%-16s %7d %-10s %8.1f %8.1f %8.1f %8.2f %8.2f\n", name, n,
+	       names[p], (double) insert / n, (double) found / n / ROUNDS,
+	       (double) missed / n / ROUNDS, stats.hitProbes,
+	       stats.missProbes);
+
+	destroySet(sp);
+    }
+}
+
+
+/*
+ * Function:    benchWords
+ *
+ * Description: Benchmark the distinct words of a file as keys, with a
+ *              copy of each with a character appended as keys that are not
+ *              in the set.
+ */
+
+static void benchWords(char *path)
+{
+    WORDS *wp;
+    SET *sp;
+    char *word, **slot, *name, **hits, **misses;
+    int i, n, length;
+
+
+    if ((wp = openWords(path)) == NULL) {
+	fprintf(stderr, "probebench: cannot open %s\n", path);
+	exit(EXIT_FAILURE);
+    }
+
+    sp = createSet(0, strcmp, hashString);
+
+    while ((word = nextWord(wp, &length)) != NULL) {
+	word = termWord(wp, word, length);
+	slot = (char **) findOrAddElement(sp, word);
+
+	if (*slot == word)
+	    *slot = keepWord(wp, word, length);
+    }
+
+    n = numElements(sp);
+    hits = getElements(sp);
+    misses = malloc(sizeof(char *) * n);
+    assert(misses != NULL);
+    destroySet(sp);
+
+    for (i = 0; i < n; i ++) {
+	length = strlen(hits[i]);
+	misses[i] = malloc(length + 2);
+	assert(misses[i] != NULL);
+
+	memcpy(misses[i], hits[i], length);
+	strcpy(misses[i] + length, "#");
+    }
+
+    name = strrchr(path, '/') != NULL ? strrchr(path, '/') + 1 : path;
+    bench(name, (void **) hits, (void **) misses, n, strcmp, hashString);
+
+    for (i = 0; i < n; i ++)
+	free(misses[i]);
+
+    free(hits);
+    free(misses);
+    closeWords(wp);
+}
+
+
+/*
+ * Function:    benchMixed
+ *
+ * Description: Benchmark N integer keys whose mixed hash values are
+ *              MIXED[i].  The keys that are not in the set have the same
+ *              mixed hash values with MISS_BIT set as well, which is above
+ *              the bits that pick the home slot, so they miss from the
+ *              same home slots.
+ */
+
+static void benchMixed(char *name, unsigned *mixed, int n)
+{
+    void **hits, **misses;
+    int i;
+
+
+    hits = malloc(sizeof(void *) * n);
+    misses = malloc(sizeof(void *) * n);
+    assert(hits != NULL && misses != NULL);
+
+    for (i = 0; i < n; i ++) {
+	assert(mixed[i] != 0 && (mixed[i] & MISS_BIT) == 0);
+	hits[i] = (void *) (intptr_t) unmix(mixed[i]);
+	misses[i] = (void *) (intptr_t) unmix(mixed[i] | MISS_BIT);
+    }
+
+    bench(name, hits, misses, n, compareInts, hashInt);
+    free(hits);
+    free(misses);
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    unsigned *mixed;
+    int i;
+
+
+    srand(1);
+    printf("%-16s %7s %-10s %8s %8s %8s %8s %8s\n", "keys", "n", "probe",
+	   "insert", "hit", "miss", "p(hit)", "p(miss)");
+
+    for (i = 1; i < argc; i ++)
+	benchWords(argv[i]);
+
+
+    /* The home slot is taken from the mixed hash value shifted right by
+       seven bits, and the low seven bits are the tag.  The keys with the
+       same home slot differ only in their tags and in the bits above
+       every home slot they can have, and the keys with consecutive home
+       slots fill half of the table that ONE_RUN_KEYS grows to. */
+
+    mixed = malloc(sizeof(unsigned) * ONE_RUN_KEYS);
+    assert(mixed != NULL);
+
+    for (i = 0; i < SAME_HOME_KEYS; i ++)
+	mixed[i] = (i >> 7) << 24 | 1 << 7 | (i & 0x7F);
+
+    benchMixed("same home", mixed, SAME_HOME_KEYS);
+
+    for (i = 0; i < ONE_RUN_KEYS; i ++)
+	mixed[i] = (i + 1) << 7 | (i & 0x7F);
+
+    benchMixed("one run", mixed, ONE_RUN_KEYS);
+
+    free(mixed);
+    exit(EXIT_SUCCESS);
+}
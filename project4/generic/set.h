@@ -14,8 +14,41 @@
 
 typedef struct set SET;
 
+typedef struct cursor {
+    int index;			/* next slot to visit */
+} CURSOR;
+
+# define SET_BLOOM	1	/* keep a Bloom filter for fast misses */
+# define SET_QUADRATIC	2	/* probe groups at triangular offsets */
+# define SET_DOUBLE	4	/* probe groups at a step from a second hash */
+
+/* The statistics returned by getSetStats.  A probe is one group of slots
+   whose control bytes are read at once, or one bucket of the cuckoo table.
+   Entry i of the histogram counts the elements that take i probes to
+   find, and the last entry also counts any that take more.  The calls to
+   the compare function are only counted if the set is compiled with
+   SET_STATS defined, as in make CFLAGS="-g -Wall -DSET_STATS". */
+
+# define SET_HISTOGRAM	16
+
+typedef struct stats {
+    int count;			/* number of elements */
+    int length;			/* number of slots */
+    int deleted;		/* number of tombstones */
+    double load;		/* elements per slot */
+    double hitProbes;		/* average probes to find an element */
+    double missProbes;		/* average probes to miss */
+    int maxHit;			/* most probes to find an element */
+    int maxMiss;		/* most probes to miss */
+    int histogram[SET_HISTOGRAM];	/* elements by probes to find */
+    long compares;		/* compare calls, or -1 if not counted */
+} STATS;
+
 SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)());
 
+SET *createSetWith(int maxElts, int (*compare)(), unsigned (*hash)(),
+		   int flags);
+
 void destroySet(SET *sp);
 
 int numElements(SET *sp);
@@ -26,6 +59,46 @@ void removeElement(SET *sp, void *elt);
 
 void *findElement(SET *sp, void *elt);
 
+void **findOrAddElement(SET *sp, void *elt);
+
+void removeSlot(SET *sp, void **slot);
+
+void addElements(SET *sp, void **elts, int n);
+
+void findElements(SET *sp, void **elts, int n, void **results);
+
 void *getElements(SET *sp);
 
+void beginElements(SET *sp, CURSOR *cp);
+
+void *nextElement(SET *sp, CURSOR *cp);
+
+void forEachElement(SET *sp, void (*visit)(), void *arg);
+
+SET *setUnion(SET *sp1, SET *sp2);
+
+SET *setIntersect(SET *sp1, SET *sp2);
+
+SET *setDifference(SET *sp1, SET *sp2);
+
+void getSetStats(SET *sp, STATS *stats);
+
+/* These calls are the same as addElement, removeElement, findElement, and
+   findOrAddElement, except that they take the value of the hash function
+   of the set for the element, so that a caller that has already computed
+   it, as the concurrent set does to pick a shard, need not compute it
+   again. */
+
+void addHashedElement(SET *sp, void *elt, unsigned hash);
+
+void removeHashedElement(SET *sp, void *elt, unsigned hash);
+
+void *findHashedElement(SET *sp, void *elt, unsigned hash);
+
+void **findOrAddHashedElement(SET *sp, void *elt, unsigned hash);
+
+unsigned hashBytes(void *key, int length, unsigned seed);
+
+unsigned hashString(char *s);
+
 # endif /* SET_H */
@@ -0,0 +1,99 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "sketch.h"
+
+#define ROW_SEED 0x9747b28c
+
+struct sketch
+{
+	uint32_t *counts;
+	int width;
+	int depth;
+	unsigned (*hash)();
+};
+
+static void locate(SKETCH *sp, void *elt, uint32_t **cells);
+static unsigned mix(unsigned hash);
+
+
+// Creates and allocates memory to the sketch, which is a table of depth rows of width counters each, all zero. The width is rounded up to a power of two. Each element has one counter in every row, and the estimate of its count is the smallest of them, so the estimate is off by no more than about e/width of the total count with probability about 1-e^-depth
+// O(width*depth)
+SKETCH *createSketch(int width, int depth, unsigned (*hash)())
+{
+	SKETCH *sp=malloc(sizeof(SKETCH));
+	assert(sp!=NULL && hash!=NULL && width>0 && depth>0 && depth<=MAX_DEPTH);
+	sp->width=1;
+	while(sp->width<width)
+		sp->width*=2;
+	sp->depth=depth;
+	sp->hash=hash;
+	sp->counts=calloc((size_t)sp->width*depth, sizeof(uint32_t));
+	assert(sp->counts!=NULL);
+	return sp;
+}
+
+// Frees up the memory allocated to the sketch
+// O(1)
+void destroySketch(SKETCH *sp)
+{
+	assert(sp!=NULL);
+	free(sp->counts);
+	free(sp);
+}
+
+// Adds one to the count of the element and returns its new estimate. This is a conservative update: rather than every counter of the element being incremented, each is only raised to the new estimate if it is below it. The counters that other elements have already pushed above the estimate are left alone, so they pick up less error, and the estimate is still never lower than the true count
+// O(depth)
+int addToSketch(SKETCH *sp, void *elt)
+{
+	assert(sp!=NULL && elt!=NULL);
+	int i;
+	uint32_t *cells[MAX_DEPTH], least;
+	locate(sp, elt, cells);
+	least=*cells[0];
+	for(i=1;i<sp->depth;i++)
+		if(*cells[i]<least)
+			least=*cells[i];
+	least++;
+	for(i=0;i<sp->depth;i++)
+		if(*cells[i]<least)
+			*cells[i]=least;
+	return least;
+}
+
+// Returns the estimate of the count of the element, which is the smallest of its counters
+// O(depth)
+int estimateCount(SKETCH *sp, void *elt)
+{
+	assert(sp!=NULL && elt!=NULL);
+	int i;
+	uint32_t *cells[MAX_DEPTH], least;
+	locate(sp, elt, cells);
+	least=*cells[0];
+	for(i=1;i<sp->depth;i++)
+		if(*cells[i]<least)
+			least=*cells[i];
+	return least;
+}
+
+// Fills in the array cells with the address of the counter of the element in each row. The hash function is only called once: the counter in row i is picked by h1+i*h2, where h1 is the mixed hash value and h2 is the hash value mixed again with a different seed and made odd, which behaves like independent hash functions for each row
+// O(depth)
+static void locate(SKETCH *sp, void *elt, uint32_t **cells)
+{
+	int i;
+	unsigned h1=mix((*sp->hash)(elt)), h2=mix(h1^ROW_SEED)|1;
+	for(i=0;i<sp->depth;i++)
+		cells[i]=&sp->counts[(size_t)i*sp->width+((h1+i*h2)&(sp->width-1))];
+}
+
+// Mixes the bits of the hash value given by the interface, since only the low bits pick a counter; This is the finalizer of MurmurHash3
+// O(1)
+static unsigned mix(unsigned hash)
+{
+	hash^=hash>>16;
+	hash*=0x85ebca6b;
+	hash^=hash>>13;
+	hash*=0xc2b2ae35;
+	hash^=hash>>16;
+	return hash;
+}
@@ -0,0 +1,28 @@
+/*
+ * File:        sketch.h
+ *
+ * Description: This file contains the public function and type
+ *              declarations for a Count-Min sketch of generic pointer
+ *              types.  A sketch estimates how many times each element has
+ *              been added to it in a fixed amount of memory, however many
+ *              distinct elements there are.  An estimate is never lower
+ *              than the true count.  The elements themselves are not kept,
+ *              so only their hash values are needed.
+ */
+
+# ifndef SKETCH_H
+# define SKETCH_H
+
+# define MAX_DEPTH	16	/* most rows that a sketch may have */
+
+typedef struct sketch SKETCH;
+
+SKETCH *createSketch(int width, int depth, unsigned (*hash)());
+
+void destroySketch(SKETCH *sp);
+
+int addToSketch(SKETCH *sp, void *elt);
+
+int estimateCount(SKETCH *sp, void *elt);
+
+# endif /* SKETCH_H */
@@ -0,0 +1,179 @@
+/*
+ * File:        sketchbench.c
+ *
+ * Description: This file contains a benchmark that compares the counts of
+ *              the Count-Min sketch of sketch.c with the exact counts kept
+ *              in a set of entries, as counts does.
+ *
+ *              The program takes a file as a command line argument, whose
+ *              words are read into memory first.  The words are counted
+ *              exactly in a set, and then in sketches of several widths
+ *              and depths, and the time per word of each is printed along
+ *              with the memory it takes.  For each sketch, the average and
+ *              largest amount by which the estimates of the distinct words
+ *              are over their counts are printed, along with the fraction
+ *              of the distinct words whose estimates are exact.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <stdint.h>
+# include <time.h>
+# include <assert.h>
+# include "set.h"
+# include "sketch.h"
+# include "wordcount.h"
+# include "words.h"
+
+
+/* The widths and depths of the sketches, in the order they are printed. */
+
+static int widths[] = {1 << 10, 1 << 12, 1 << 14, 1 << 16};
+static int depths[] = {2, 4, 8};
+
+
+/*
+ * Function:    now
+ *
+ * Description: Return the current time in nanoseconds.
+ */
+
+static long long now(void)
+{
+    struct timespec ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    WORDS *wp;
+    SET *sp;
+    SKETCH *sketch;
+    STATS stats;
+    struct entry *entries, **distinct, *ep, e;
+    char *word, **words;
+    long long start, elapsed;
+    long over, worst;
+    int i, j, d, n, m, exact, estimate, length;
+
+
+    /* Check usage and read the words of the file. */
+
+    if (argc != 2) {
+	fprintf(stderr, "usage: %s file\n", argv[0]);
+	exit(EXIT_FAILURE);
+    }
+
+    if ((wp = openWords(argv[1])) == NULL) {
+	fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
+	exit(EXIT_FAILURE);
+    }
+
+    n = 0;
+    words = NULL;
+
+    while ((word = nextWord(wp, &length)) != NULL) {
+	word = keepWord(wp, word, length);
+
+	if ((n & (n - 1)) == 0) {
+	    words = realloc(words, sizeof(char *) * (n == 0 ? 1 : n * 2));
+	    assert(words != NULL);
+	}
+
+	words[n ++] = word;
+    }
+
+
+    /* Count the words exactly, taking each new entry from an array with
+       room for every word so that the time of malloc is not counted. */
+
+    entries = malloc(sizeof(struct entry) * (n == 0 ? 1 : n));
+    assert(entries != NULL);
+    m = 0;
+
+    start = now();
+    sp = createSet(0, compareEntries, hashEntry);
+
+    for (i = 0; i < n; i ++) {
+	e.word = words[i];
+
+	if ((ep = findElement(sp, &e)) != NULL)
+	    ep->count ++;
+	else {
+	    ep = &entries[m ++];
+	    ep->word = words[i];
+	    ep->count = 1;
+	    ep->first = i;
+	    addElement(sp, ep);
+	}
+    }
+
+    elapsed = now() - start;
+    assert(numElements(sp) == m);
+
+    getSetStats(sp, &stats);
+    distinct = getElements(sp);
+
+    printf("%d words, %d distinct\n", n, m);
+    printf("%-16s %10s %10s %10s %10s %10s\n", "counter", "ns/word",
+	   "bytes", "avg over", "max over", "exact");
+    printf("%-16s %10.1f %10ld %10.2f %10d %10.3f\n", "table",
+	   (double) elapsed / (n == 0 ? 1 : n),
+	   (long) stats.length * (sizeof(void *) + sizeof(unsigned) + 1) +
+	   (long) m * sizeof(struct entry), 0.0, 0, 1.0);
+
+
+    /* Count the words in each sketch and compare its estimates of the
+       distinct words with their counts. */
+
+    for (i = 0; i < (int) (sizeof(widths) / sizeof(widths[0])); i ++)
+	for (d = 0; d < (int) (sizeof(depths) / sizeof(depths[0])); d ++) {
+	    start = now();
+	    sketch = createSketch(widths[i], depths[d], hashString);
+
+	    for (j = 0; j < n; j ++)
+		addToSketch(sketch, words[j]);
+
+	    elapsed = now() - start;
+	    over = 0;
+	    worst = 0;
+	    exact = 0;
+
+	    for (j = 0; j < m; j ++) {
+		estimate = estimateCount(sketch, distinct[j]->word);
+		assert(estimate >= distinct[j]->count);
+
+		over += estimate - distinct[j]->count;
+		exact += estimate == distinct[j]->count;
+
+		if (estimate - distinct[j]->count > worst)
+		    worst = estimate - distinct[j]->count;
+	    }
+
+	    printf("%6d x %-7d %10.1f %10ld %10.2f %10ld %10.3f\n",
+		   widths[i], depths[d], (double) elapsed / (n == 0 ? 1 : n),
+		   (long) widths[i] * depths[d] * sizeof(uint32_t),
+		   (double) over / (m == 0 ? 1 : m), worst,
+		   (double) exact / (m == 0 ? 1 : m));
+
+	    destroySketch(sketch);
+	}
+
+    free(distinct);
+    free(entries);
+    free(words);
+    destroySet(sp);
+    closeWords(wp);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,361 @@
+/*
+ * File:        specbench.c
+ *
+ * Description: This file contains a benchmark that compares the set
+ *              abstract data type of table.c, which calls its compare and
+ *              hash functions through pointers, with sets generated by
+ *              DEFINE_SET for one type of element.
+ *
+ *              The program takes a file and an optional number of integers
+ *              as command line arguments.  The distinct words of the file
+ *              are used as string keys, and the given number of distinct
+ *              random integers as integer keys.  For each kind of key,
+ *              both sets are timed inserting every key, looking up every
+ *              key, and looking up as many keys that are not in the set,
+ *              each in a random order.  The time per operation and the
+ *              speedup of the generated set are printed.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <stdint.h>
+# include <time.h>
+# include <assert.h>
+# include "set.h"
+# include "typedset.h"
+# include "words.h"
+
+
+# define ROUNDS 5
+# define DEFAULT_INTS 1000000
+
+
+/* Hash and equal functions for the generated sets, which are inlined. */
+
+static inline unsigned hashInt(intptr_t x)
+{
+    return (unsigned) x * 0x9e3779b1u;
+}
+
+# define equalInts(x, y)	((x) == (y))
+# define equalStrings(s, t)	(strcmp(s, t) == 0)
+
+DEFINE_SET(IntSet, intptr_t, hashInt, equalInts)
+DEFINE_SET(StringSet, char *, hashString, equalStrings)
+
+
+/*
+ * Function:    compareInts
+ *
+ * Description: Compare two integers stored as pointers for the set of
+ *              table.c.
+ */
+
+static int compareInts(void *p1, void *p2)
+{
+    intptr_t x = (intptr_t) p1, y = (intptr_t) p2;
+
+
+    return x < y ? -1 : x > y;
+}
+
+
+/*
+ * Function:    hashIntPointer
+ *
+ * Description: Hash an integer stored as a pointer for the set of
+ *              table.c, in the same way as hashInt.
+ */
+
+static unsigned hashIntPointer(void *p)
+{
+    return hashInt((intptr_t) p);
+}
+
+
+/*
+ * Function:    now
+ *
+ * Description: Return the current time in nanoseconds.
+ */
+
+static long long now(void)
+{
+    struct timespec ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+/*
+ * Function:    shuffle
+ *
+ * Description: Shuffle an array of N pointers.
+ */
+
+static void shuffle(void **keys, int n)
+{
+    void *tmp;
+    int i, j;
+
+
+    for (i = n - 1; i > 0; i --) {
+	j = rand() % (i + 1);
+	tmp = keys[i];
+	keys[i] = keys[j];
+	keys[j] = tmp;
+    }
+}
+
+
+/*
+ * Function:    report
+ *
+ * Description: Print the time per operation of the dynamic and generated
+ *              sets for one kind of operation on N keys.
+ */
+
+static void report(char *name, long long dynamic, long long typed, long n)
+{
+    printf("%-16s %10.1f %10.1f %10.2f\n", name, (double) dynamic / n,
+	   (double) typed / n, (double) dynamic / typed);
+}
+
+
+/*
+ * Function:    benchStrings
+ *
+ * Description: Time both sets on the N string keys in HITS, and the N
+ *              string keys in MISSES that are not among them.
+ */
+
+static void benchStrings(char **hits, char **misses, int n)
+{
+    SET *sp;
+    StringSet *tp;
+    long long start, dynamic[3], typed[3];
+    int i, k;
+
+
+    /* The keys come in the order of a table with the same hash function,
+       so they are shuffled first, since inserting them in that order
+       would pile them up in a smaller table. */
+
+    shuffle((void **) hits, n);
+
+    start = now();
+    sp = createSet(0, strcmp, hashString);
+
+    for (i = 0; i < n; i ++)
+	addElement(sp, hits[i]);
+
+    dynamic[0] = now() - start;
+
+    start = now();
+    tp = createStringSet(0);
+
+    for (i = 0; i < n; i ++)
+	addStringSetElement(tp, hits[i]);
+
+    typed[0] = now() - start;
+    assert(numElements(sp) == n && numStringSetElements(tp) == n);
+    shuffle((void **) hits, n);
+
+    start = now();
+
+    for (k = 0; k < ROUNDS; k ++)
+	for (i = 0; i < n; i ++)
+	    assert(findElement(sp, hits[i]) == hits[i]);
+
+    dynamic[1] = now() - start;
+
+    start = now();
+
+    for (k = 0; k < ROUNDS; k ++)
+	for (i = 0; i < n; i ++)
+	    assert(*findStringSetElement(tp, hits[i]) == hits[i]);
+
+    typed[1] = now() - start;
+
+    start = now();
+
+    for (k = 0; k < ROUNDS; k ++)
+	for (i = 0; i < n; i ++)
+	    assert(findElement(sp, misses[i]) == NULL);
+
+    dynamic[2] = now() - start;
+
+    start = now();
+
+    for (k = 0; k < ROUNDS; k ++)
+	for (i = 0; i < n; i ++)
+	    assert(findStringSetElement(tp, misses[i]) == NULL);
+
+    typed[2] = now() - start;
+
+    printf("%d string keys\n", n);
+    report("  insert", dynamic[0], typed[0], n);
+    report("  lookup hit", dynamic[1], typed[1], (long) n * ROUNDS);
+    report("  lookup miss", dynamic[2], typed[2], (long) n * ROUNDS);
+
+    destroySet(sp);
+    destroyStringSet(tp);
+}
+
+
+/*
+ * Function:    benchInts
+ *
+ * Description: Time both sets on N distinct random integer keys, and on
+ *              N other integer keys that are not in the sets.
+ */
+
+static void benchInts(int n)
+{
+    SET *sp;
+    IntSet *tp;
+    intptr_t *keys;
+    long long start, dynamic[3], typed[3];
+    int i, k;
+
+
+    /* Odd keys are in the sets and even keys are not, and none is zero,
+       since the set of table.c cannot hold a null pointer. */
+
+    keys = malloc(sizeof(intptr_t) * n * 2);
+    assert(keys != NULL);
+
+    for (i = 0; i < n * 2; i ++)
+	keys[i] = (intptr_t) (((unsigned) i * 2654435761u) | 1) - (i >= n);
+
+    start = now();
+    sp = createSet(0, compareInts, hashIntPointer);
+
+    for (i = 0; i < n; i ++)
+	addElement(sp, (void *) keys[i]);
+
+    dynamic[0] = now() - start;
+
+    start = now();
+    tp = createIntSet(0);
+
+    for (i = 0; i < n; i ++)
+	addIntSetElement(tp, keys[i]);
+
+    typed[0] = now() - start;
+    assert(numElements(sp) == n && numIntSetElements(tp) == n);
+    shuffle((void **) keys, n);
+
+    start = now();
+
+    for (k = 0; k < ROUNDS; k ++)
+	for (i = 0; i < n; i ++)
+	    assert(findElement(sp, (void *) keys[i]) == (void *) keys[i]);
+
+    dynamic[1] = now() - start;
+
+    start = now();
+
+    for (k = 0; k < ROUNDS; k ++)
+	for (i = 0; i < n; i ++)
+	    assert(*findIntSetElement(tp, keys[i]) == keys[i]);
+
+    typed[1] = now() - start;
+
+    start = now();
+
+    for (k = 0; k < ROUNDS; k ++)
+	for (i = n; i < n * 2; i ++)
+	    assert(findElement(sp, (void *) keys[i]) == NULL);
+
+    dynamic[2] = now() - start;
+
+    start = now();
+
+    for (k = 0; k < ROUNDS; k ++)
+	for (i = n; i < n * 2; i ++)
+	    assert(findIntSetElement(tp, keys[i]) == NULL);
+
+    typed[2] = now() - start;
+
+    printf("%d integer keys\n", n);
+    report("  insert", dynamic[0], typed[0], n);
+    report("  lookup hit", dynamic[1], typed[1], (long) n * ROUNDS);
+    report("  lookup miss", dynamic[2], typed[2], (long) n * ROUNDS);
+
+    destroySet(sp);
+    destroyIntSet(tp);
+    free(keys);
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    WORDS *wp;
+    SET *sp;
+    char *word, **slot, **hits, **misses;
+    int i, n, length;
+
+
+    /* Check usage and collect the distinct words of the file. */
+
+    if (argc < 2 || argc > 3) {
+	fprintf(stderr, "usage: %s file [integers]\n", argv[0]);
+	exit(EXIT_FAILURE);
+    }
+
+    if ((wp = openWords(argv[1])) == NULL) {
+	fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
+	exit(EXIT_FAILURE);
+    }
+
+    sp = createSet(0, strcmp, hashString);
+
+    while ((word = nextWord(wp, &length)) != NULL) {
+	word = termWord(wp, word, length);
+	slot = (char **) findOrAddElement(sp, word);
+
+	if (*slot == word)
+	    *slot = keepWord(wp, word, length);
+    }
+
+    n = numElements(sp);
+    hits = getElements(sp);
+    misses = malloc(sizeof(char *) * n);
+    assert(misses != NULL);
+    destroySet(sp);
+
+
+    /* Make a key that is not in the set for each word. */
+
+    for (i = 0; i < n; i ++) {
+	length = strlen(hits[i]);
+	misses[i] = malloc(length + 2);
+	assert(misses[i] != NULL);
+
+	memcpy(misses[i], hits[i], length);
+	strcpy(misses[i] + length, "#");
+    }
+
+    srand(1);
+    printf("%-16s %10s %10s %10s\n", "ns/op", "table.c", "typedset", "speedup");
+    benchStrings(hits, misses, n);
+    benchInts(argc == 3 ? atoi(argv[2]) : DEFAULT_INTS);
+
+    for (i = 0; i < n; i ++)
+	free(misses[i]);
+
+    free(hits);
+    free(misses);
+    closeWords(wp);
+    exit(EXIT_SUCCESS);
+}
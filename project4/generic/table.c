@@ -3,164 +3,1161 @@
 #include <string.h>
 #include "set.h"
 #include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #define EMPTY 0
-#define FILLED 1
-#define DELETED 2
+#define DELETED 1
+#define FILLED 0x80
+#define GROUP 16
 
-struct set
+#define MIN_LENGTH 16
+#define MAX_LOAD(n) ((n)/8*7)
+#define MAX_DELETED(n) ((n)/8)
+#define MIGRATE_SLOTS 16
+
+#define BATCH_SIZE 64
+
+#define DOUBLE_SEED 0x165667b1
+
+#define PASS_SLOTS 65536
+#define MAX_THREADS 16
+
+#define BLOOM_WORDS 8
+#define BLOOM_SEED 0x27d4eb2f
+#define MAX_STALE(n) (n)
+
+#ifdef SET_STATS
+#define COMPARE(sp, x, y) ((sp)->compares++, (*(sp)->compare)((x), (y)))
+#else
+#define COMPARE(sp, x, y) ((*(sp)->compare)((x), (y)))
+#endif
+
+struct table
 {
 	void **data;
-	char *flags;
+	unsigned *hashes;
+	unsigned char *ctrl;
 	int length;
 	int count;
+	int deleted;
+};
+
+struct set
+{
+	struct table cur;
+	struct table old;
+	int migrated;
 	int (*compare)();
 	unsigned (*hash)();
+	int probe;
+	uint32_t *filter;
+	int blocks;
+	uint32_t *nextFilter;
+	int nextBlocks;
+	int stale;
+#ifdef SET_STATS
+	long compares;
+#endif
 };
 
-static int search(SET *sp, void *elt, bool *found);
+struct pass
+{
+	SET *walked;
+	SET *probed;
+	int start;
+	int end;
+	bool keep;
+	bool probedElts;
+	void **elts;
+	unsigned *hashes;
+	int count;
+	int size;
+};
 
+static const uint32_t salts[BLOOM_WORDS]={0x47b6137b, 0x44974d91, 0x8824ad5b, 0xa2b7289d, 0x705495c7, 0x2df1424b, 0x9efc4947, 0x5c6bfb31};
 
-// Creates and allocates memory to the set that holds the pointer to the array of pointers that point to the strings, the string of flags, the current number of elements in the array, and the max number of elements in the array. It also allocates memory for the flag array. In addition, it also sets all the flags in the string to EMPTY
+static void initTable(struct table *tp, int length);
+static void freeTable(struct table *tp);
+static int search(SET *sp, struct table *tp, void *elt, unsigned hash, bool *found);
+static int locate(SET *sp, void *elt, unsigned hash, struct table **tpp, bool *found);
+static void **insert(SET *sp, int idx, void *elt, unsigned hash);
+static void erase(SET *sp, struct table *tp, int idx);
+static void place(struct table *tp, int idx, void *elt, unsigned hash);
+static void setCtrl(struct table *tp, int idx, unsigned char c);
+static bool canEmpty(struct table *tp, int idx);
+static void migrate(SET *sp, int slots);
+static void grow(SET *sp);
+static void prefetch(SET *sp, void **elts, int n, unsigned *hashes);
+static void prefetchHome(SET *sp, unsigned hash);
+static void prefetchMatches(SET *sp, int n, unsigned *hashes);
+static SET *cloneSet(SET *sp);
+static void copyTable(struct table *tp, struct table *from);
+static int walk(SET *walked, SET *probed, bool keep, bool probedElts, struct pass *passes);
+static void *walkRange(void *arg);
+static void keepElement(struct pass *pp, void *elt, unsigned hash);
+static void addHashed(SET *sp, void **elts, unsigned *hashes, int n, bool replace);
+static void mergeSet(SET *sp, SET *from);
+static void removeHashed(SET *sp, void **elts, unsigned *hashes, int n);
+static void initFilter(SET *sp, int length);
+static void startFilter(SET *sp, int length);
+static uint32_t *filterBlock(SET *sp, unsigned hash);
+static uint32_t *nextBlock(SET *sp, unsigned hash);
+static void addFilter(SET *sp, unsigned hash);
+static void setBits(uint32_t *bp, unsigned hash);
+static bool maybeContains(SET *sp, unsigned hash);
+static void tableStats(SET *sp, struct table *tp, struct table *before, STATS *stats);
+static int missGroups(SET *sp, struct table *tp, unsigned hash);
+static int hitGroups(SET *sp, struct table *tp, int idx);
+static unsigned firstStep(SET *sp, unsigned hash);
+static unsigned mix(unsigned hash);
+static unsigned matchTag(unsigned char *group, unsigned char tag);
+static unsigned matchEmpty(unsigned char *group);
+static unsigned matchFree(unsigned char *group);
+
+
+// Creates a set without any of the options of createSetWith
 // O(n)
 SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)())
 {
-	int i;
+	return createSetWith(maxElts, compare, hash, 0);
+}
+
+// Creates and allocates memory to the set. The table is sized so that maxElts elements fit under the maximum load factor, but maxElts is only a hint: the set grows by itself once the load factor is crossed, so there is no upper limit on the number of elements. If SET_BLOOM is given in flags, the set also keeps a Bloom filter of the hash values of its elements, which lets findElement and removeElement turn most elements that are not in the set away after reading a single block of the filter, without probing the table. The groups of the table are probed one after another from the home slot unless SET_QUADRATIC or SET_DOUBLE is given to pick another probe sequence
+// O(n)
+SET *createSetWith(int maxElts, int (*compare)(), unsigned (*hash)(), int flags)
+{
+	int length=MIN_LENGTH;
 	SET *sp = malloc(sizeof(SET));
-	assert(sp!=NULL);
-	sp->data=malloc(sizeof(void*)*maxElts);
-	assert(sp->data!=NULL);
-	sp->flags=malloc(sizeof(char)*maxElts);
-	assert(sp->flags!=NULL);
-	sp->length=maxElts;
-	sp->count=0;
+	int probe=flags&(SET_QUADRATIC|SET_DOUBLE);
+	assert(sp!=NULL && compare!=NULL && hash!=NULL && (flags&~(SET_BLOOM|SET_QUADRATIC|SET_DOUBLE))==0 && probe!=(SET_QUADRATIC|SET_DOUBLE));
+	while(MAX_LOAD(length)<maxElts)
+		length*=2;
+	initTable(&sp->cur, length);
+	sp->old.data=NULL;
+	sp->migrated=0;
 	sp->compare=compare;
 	sp->hash=hash;
-	for(i=0;i<maxElts;i++)
-		sp->flags[i]=EMPTY;
+	sp->probe=probe;
+	sp->filter=NULL;
+	sp->nextFilter=NULL;
+	if(flags&SET_BLOOM)
+		initFilter(sp, length);
+#ifdef SET_STATS
+	sp->compares=0;
+#endif
 	return sp;
 }
 
-// Frees up the memory allocated to the set
+// Frees up the memory allocated to the set, including the old table if a rehash is still in progress
 // O(1)
-void destroySet(SET *sp) 
+void destroySet(SET *sp)
 {
 	assert(sp!=NULL);
-	free(sp->data);
-	free(sp->flags);
+	freeTable(&sp->cur);
+	if(sp->old.data!=NULL)
+		freeTable(&sp->old);
+	free(sp->filter);
+	free(sp->nextFilter);
 	free(sp);
-	return; 
+	return;
 }
 
-// Returns the number of elements in the array pointed to by void **data
+// Returns the number of elements in the set, which are split between the current table and the part of the old table that has not been migrated yet
 // O(1)
 int numElements(SET *sp)
 {
 	assert(sp!=NULL);
-	return sp->count;
+	if(sp->old.data!=NULL)
+		return sp->cur.count+sp->old.count;
+	return sp->cur.count;
 }
 
-// Adds the element to the array pointed to by void **data assuming that the element is not already in the array and that the array is not full, while also updating the count of elements in the array; First, it inserts the element into the array. Next, it changes the corresponding index in the flag string to FILLED. Finally, it updates the count
-// O(n) 
-void addElement(SET *sp, void *elt)
+// Adds the element to the set assuming that the element is not already in the set, whose hash value given by the hash function of the set is hash; First, it checks both tables for the element. If it is not present, it grows the table if the load factor would be crossed and inserts the element into the current table
+// O(1) expected
+void addHashedElement(SET *sp, void *elt, unsigned hash)
 {
-	assert(sp!=NULL && elt!=NULL && sp->count < sp->length);
-	int i, idx;
+	assert(sp!=NULL && elt!=NULL);
+	int idx;
 	bool found = false;
-	idx=search(sp, elt, &found);
+	struct table *tp;
+	hash=mix(hash);
+	idx=locate(sp, elt, hash, &tp, &found);
 	if(found==false)
-	{
-		sp->data[idx]=elt;
-		assert(sp->data[idx]!=NULL);
-		sp->flags[idx]=FILLED;
-		sp->count++;
-	}	
+		insert(sp, idx, elt, hash);
 }
 
-// Removes the element from the array pointed to by void **data assuming that the element is in said array, while also updating the count of elements in the array; First, it changes the corresponding index in the flag string to DELETED, which will prevent the element in that index from being returned to the interface in *getElements. Finally, it updates the count 
-// O(n) 
-void removeElement(SET *sp, void *elt)
+// Removes the element from whichever table holds it, assuming that the element is in the set and that its hash value given by the hash function of the set is hash
+// O(1) expected
+void removeHashedElement(SET *sp, void *elt, unsigned hash)
 {
 	assert(sp!=NULL && elt!=NULL);
 	int idx;
 	bool found = false;
-	idx=search(sp, elt, &found);
+	struct table *tp;
+	hash=mix(hash);
+	if(sp->filter!=NULL && maybeContains(sp, hash)==false)
+		return;
+	idx=locate(sp, elt, hash, &tp, &found);
 	if(found==true)
-	{
-		assert(sp->data[idx]!=NULL);
-		sp->flags[idx]=DELETED;
-		sp->count--;
-	}
+		erase(sp, tp, idx);
 }
 
-// Public search function that finds the element pointed to by void *elt and returns the element if found. Else, it returns NULL to indicate that the element was not found
-// O(n)
-void *findElement(SET *sp, void *elt)
+// Public search function that finds the element matching void *elt, whose hash value given by the hash function of the set is hash, and returns the element stored in the set if found. Else, it returns NULL to indicate that the element was not found. If the set has a Bloom filter, an element that the filter rules out is not searched for at all. Lookups never migrate slots, so they leave the set untouched
+// O(1) expected
+void *findHashedElement(SET *sp, void *elt, unsigned hash)
 {
 	assert(sp!=NULL && elt!=NULL);
+	int idx;
 	bool found = false;
-	search(sp, elt, &found);
+	struct table *tp;
+	hash=mix(hash);
+	if(sp->filter!=NULL && maybeContains(sp, hash)==false)
+		return NULL;
+	idx=locate(sp, elt, hash, &tp, &found);
 	if(found==false)
 		return NULL;
-	else
-		return elt;
+	return tp->data[idx];
+}
+
+// Finds the element matching void *elt or adds elt if there is none, using a single search given the hash value of elt from the hash function of the set; It returns the address of the slot that holds the matching element, so the caller can tell the two cases apart by checking whether the slot holds elt itself. The caller may store a different but equal element in the slot, such as a permanent copy of elt. The address is only valid until the next call that changes the set
+// O(1) expected
+void **findOrAddHashedElement(SET *sp, void *elt, unsigned hash)
+{
+	assert(sp!=NULL && elt!=NULL);
+	int idx;
+	bool found = false;
+	struct table *tp;
+	hash=mix(hash);
+	idx=locate(sp, elt, hash, &tp, &found);
+	if(found==true)
+		return &tp->data[idx];
+	return insert(sp, idx, elt, hash);
+}
+
+// Adds the element to the set as addHashedElement does, computing its hash value with the hash function of the set
+// O(1) expected
+void addElement(SET *sp, void *elt)
+{
+	assert(sp!=NULL && elt!=NULL);
+	addHashedElement(sp, elt, (*sp->hash)(elt));
+}
+
+// Removes the element from the set as removeHashedElement does, computing its hash value with the hash function of the set
+// O(1) expected
+void removeElement(SET *sp, void *elt)
+{
+	assert(sp!=NULL && elt!=NULL);
+	removeHashedElement(sp, elt, (*sp->hash)(elt));
+}
+
+// Finds the element matching void *elt as findHashedElement does, computing its hash value with the hash function of the set
+// O(1) expected
+void *findElement(SET *sp, void *elt)
+{
+	assert(sp!=NULL && elt!=NULL);
+	return findHashedElement(sp, elt, (*sp->hash)(elt));
+}
+
+// Finds the element matching void *elt or adds elt as findOrAddHashedElement does, computing its hash value with the hash function of the set
+// O(1) expected
+void **findOrAddElement(SET *sp, void *elt)
+{
+	assert(sp!=NULL && elt!=NULL);
+	return findOrAddHashedElement(sp, elt, (*sp->hash)(elt));
 }
 
-// Allocates memory to a new array that holds the data from sp->data to be returned to the interface. It copies the data from sp->data to the new array assuming that there is actually information present, which is indicated by the flag array. After which, the new array is returned to the interface
+// Removes the element held in the slot at the given address, which must have been returned by findOrAddElement since the set was last changed, so the element is removed without searching for it again
+// O(1) expected
+void removeSlot(SET *sp, void **slot)
+{
+	assert(sp!=NULL && slot!=NULL);
+	struct table *tp=&sp->cur;
+	if(slot<tp->data || slot>=tp->data+tp->length)
+		tp=&sp->old;
+	assert(tp->data!=NULL && slot>=tp->data && slot<tp->data+tp->length);
+	erase(sp, tp, slot-tp->data);
+}
+
+// Adds each of the n elements of the array elts to the set as addElement does, in order, so an element that is already in the set or earlier in the array is skipped. The elements are taken BATCH_SIZE at a time: all of their hash values are computed and their home slots are prefetched before any of them is searched for, so the cache misses of the whole batch overlap instead of being taken one after another
+// O(n) expected
+void addElements(SET *sp, void **elts, int n)
+{
+	assert(sp!=NULL && (elts!=NULL || n==0));
+	int i, j, m, idx;
+	bool found;
+	struct table *tp;
+	unsigned hashes[BATCH_SIZE];
+	for(i=0;i<n;i+=BATCH_SIZE)
+	{
+		m=n-i<BATCH_SIZE ? n-i : BATCH_SIZE;
+		prefetch(sp, elts+i, m, hashes);
+		for(j=0;j<m;j++)
+		{
+			idx=locate(sp, elts[i+j], hashes[j], &tp, &found);
+			if(found==false)
+				insert(sp, idx, elts[i+j], hashes[j]);
+		}
+	}
+}
+
+// Looks up each of the n elements of the array elts as findElement does, and stores the element found in the set, or NULL, in the same position of the array results. The elements are taken BATCH_SIZE at a time and their home slots are prefetched first, as in addElements
+// O(n) expected
+void findElements(SET *sp, void **elts, int n, void **results)
+{
+	assert(sp!=NULL && ((elts!=NULL && results!=NULL) || n==0));
+	int i, j, m, idx;
+	bool found;
+	struct table *tp;
+	unsigned hashes[BATCH_SIZE];
+	for(i=0;i<n;i+=BATCH_SIZE)
+	{
+		m=n-i<BATCH_SIZE ? n-i : BATCH_SIZE;
+		prefetch(sp, elts+i, m, hashes);
+		for(j=0;j<m;j++)
+		{
+			if(sp->filter!=NULL && maybeContains(sp, hashes[j])==false)
+			{
+				results[i+j]=NULL;
+				continue;
+			}
+			idx=locate(sp, elts[i+j], hashes[j], &tp, &found);
+			results[i+j]=found ? tp->data[idx] : NULL;
+		}
+	}
+}
+
+// Allocates memory to a new array that holds the elements of the set to be returned to the interface. It copies the FILLED slots of the current table and of the old table, since the slots of the old table that were already migrated are no longer FILLED
 // O(n)
 void *getElements(SET *sp)
 {
 	assert(sp!=NULL);
 	int i;
 	int j=0;
-	void **temp=malloc(sizeof(void)*sp->count);
-	for(i=0; i<sp->length; i++)
+	void **temp=malloc(sizeof(void*)*numElements(sp));
+	assert(temp!=NULL);
+	for(i=0; i<sp->cur.length; i++)
+	{
+		if(sp->cur.ctrl[i]&FILLED)
+			temp[j++]=sp->cur.data[i];
+	}
+	if(sp->old.data!=NULL)
 	{
-		if(sp->flags[i]==FILLED)
+		for(i=sp->migrated; i<sp->old.length; i++)
 		{
-			temp[j]=sp->data[i];
-			j++;
+			if(sp->old.ctrl[i]&FILLED)
+				temp[j++]=sp->old.data[i];
 		}
 	}
 	return temp;
 }
 
-// Private search function that finds the element pointed to by void *elt. The home hashing address is determined at the beginning of the function. Throughout the execution of the 'for' loop, the index is iterated until either the string array indicates a slot is EMPTY or the element elt is found. Furthermore, in the loop, if the string indicates a DELETED spot, that deleted index is noted in case the element ends up not being in the array. That way, that deleted index can be returned in that situation.
+// Starts a traversal of the set with the cursor pointed to by cp, which the caller allocates; Together with nextElement, it visits the FILLED slots in place, so nothing is allocated or copied
+// O(1)
+void beginElements(SET *sp, CURSOR *cp)
+{
+	assert(sp!=NULL && cp!=NULL);
+	cp->index=0;
+}
+
+// Returns the element in the next FILLED slot of the traversal with the cursor pointed to by cp, or NULL once every slot has been visited. The index of the cursor runs over the current table and then over the old table, if a rehash is in progress, so the elements are visited in the same order as getElements. Lookups never migrate slots, but any other change to the set may, so the set must not be changed during the traversal
+// O(1) amortized
+void *nextElement(SET *sp, CURSOR *cp)
+{
+	assert(sp!=NULL && cp!=NULL);
+	int idx;
+	int length=sp->cur.length;
+	if(sp->old.data!=NULL)
+		length+=sp->old.length;
+	while(cp->index<length)
+	{
+		idx=cp->index++;
+		if(idx<sp->cur.length)
+		{
+			if(sp->cur.ctrl[idx]&FILLED)
+				return sp->cur.data[idx];
+		}
+		else if(sp->old.ctrl[idx-sp->cur.length]&FILLED)
+			return sp->old.data[idx-sp->cur.length];
+	}
+	return NULL;
+}
+
+// Calls (*visit)(elt, arg) on each element of the set in the order of nextElement, so that the caller can stream the elements without an array of them
 // O(n)
-static int search(SET *sp, void *elt, bool *found)
+void forEachElement(SET *sp, void (*visit)(), void *arg)
+{
+	assert(sp!=NULL && visit!=NULL);
+	CURSOR c;
+	void *elt;
+	beginElements(sp, &c);
+	while((elt=nextElement(sp, &c))!=NULL)
+		(*visit)(elt, arg);
+}
+
+// Returns a new set that holds the elements that are in either set, which must have the same compare and hash functions. The larger set is copied wholesale by cloneSet, and only the smaller one is walked. If the second set is the smaller one, walk picks out its elements that the first does not hold, which are then added to the copy with their stored hash values. If the first set is the smaller one, mergeSet adds each of its elements to the copy of the second, replacing any equal element. Either way, where both sets hold equal elements, the new set keeps the one from the first set, and it has the options of the first set. The second set can only be copied if it has the same probe sequence and also keeps a Bloom filter or not, so otherwise the first set is copied even if it is the smaller one
+// O(n+m) expected
+SET *setUnion(SET *sp1, SET *sp2)
+{
+	assert(sp1!=NULL && sp2!=NULL && sp1->compare==sp2->compare && sp1->hash==sp2->hash);
+	int i, t;
+	struct pass passes[MAX_THREADS];
+	SET *sp;
+	if(numElements(sp1)<numElements(sp2) && sp1->probe==sp2->probe && (sp1->filter!=NULL)==(sp2->filter!=NULL))
+	{
+		sp=cloneSet(sp2);
+		mergeSet(sp, sp1);
+		return sp;
+	}
+	sp=cloneSet(sp1);
+	t=walk(sp2, sp1, false, false, passes);
+	for(i=0;i<t;i++)
+	{
+		addHashed(sp, passes[i].elts, passes[i].hashes, passes[i].count, false);
+		free(passes[i].elts);
+		free(passes[i].hashes);
+	}
+	return sp;
+}
+
+// Returns a new set that holds the elements that are in both sets, which must have the same compare and hash functions. The smaller set is walked and each of its elements is looked up in the larger one, so the work depends only on the size of the smaller set; The elements that are found are then added to a new set with their stored hash values. The new set holds the elements of the first set and has its options
+// O(min(n, m)) expected
+SET *setIntersect(SET *sp1, SET *sp2)
+{
+	assert(sp1!=NULL && sp2!=NULL && sp1->compare==sp2->compare && sp1->hash==sp2->hash);
+	int i, t, n=0;
+	bool first=numElements(sp1)<=numElements(sp2);
+	struct pass passes[MAX_THREADS];
+	SET *sp;
+	t=walk(first ? sp1 : sp2, first ? sp2 : sp1, true, !first, passes);
+	for(i=0;i<t;i++)
+		n+=passes[i].count;
+	sp=createSetWith(n, sp1->compare, sp1->hash, sp1->probe|(sp1->filter!=NULL ? SET_BLOOM : 0));
+	for(i=0;i<t;i++)
+	{
+		addHashed(sp, passes[i].elts, passes[i].hashes, passes[i].count, false);
+		free(passes[i].elts);
+		free(passes[i].hashes);
+	}
+	return sp;
+}
+
+// Returns a new set that holds the elements of the first set that are not in the second, which must have the same compare and hash functions. If the first set is the smaller one, it is walked and the elements that the second set does not hold are added to a new set. Otherwise, the first set is copied wholesale by cloneSet, the second set is walked to pick out the elements that the first set holds, and only those are removed from the copy. Either way, only the smaller set is walked and probed, and neither set is changed, unlike removing the elements of the second set from the first one at a time. The new set has the options of the first set
+// O(n) expected
+SET *setDifference(SET *sp1, SET *sp2)
+{
+	assert(sp1!=NULL && sp2!=NULL && sp1->compare==sp2->compare && sp1->hash==sp2->hash);
+	int i, t, n=0;
+	bool first=numElements(sp1)<=numElements(sp2);
+	struct pass passes[MAX_THREADS];
+	SET *sp;
+	if(first)
+	{
+		t=walk(sp1, sp2, false, false, passes);
+		for(i=0;i<t;i++)
+			n+=passes[i].count;
+		sp=createSetWith(n, sp1->compare, sp1->hash, sp1->probe|(sp1->filter!=NULL ? SET_BLOOM : 0));
+	}
+	else
+	{
+		sp=cloneSet(sp1);
+		t=walk(sp2, sp1, true, true, passes);
+	}
+	for(i=0;i<t;i++)
+	{
+		if(first)
+			addHashed(sp, passes[i].elts, passes[i].hashes, passes[i].count, false);
+		else
+			removeHashed(sp, passes[i].elts, passes[i].hashes, passes[i].count);
+		free(passes[i].elts);
+		free(passes[i].hashes);
+	}
+	return sp;
+}
+
+// Fills in the statistics pointed to by stats, which are worked out from the control bytes and stored hash values alone, so the compare function is not called. The probes to miss are averaged over every home slot. While a rehash is in progress, a miss probes both tables, and an element still in the old table is found after a miss in the current one
+// O(n)
+void getSetStats(SET *sp, STATS *stats)
+{
+	assert(sp!=NULL && stats!=NULL);
+	memset(stats, 0, sizeof(STATS));
+	stats->count=numElements(sp);
+	tableStats(sp, &sp->cur, NULL, stats);
+	if(sp->old.data!=NULL)
+		tableStats(sp, &sp->old, &sp->cur, stats);
+	stats->load=(double)stats->count/stats->length;
+	if(stats->count>0)
+		stats->hitProbes/=stats->count;
+#ifdef SET_STATS
+	stats->compares=sp->compares;
+#else
+	stats->compares=-1;
+#endif
+}
+
+// Allocates the data, hash, and control arrays of a table with the given length, which must be a power of two no smaller than a group. The hash array holds the full mixed hash value of the element in each slot. Each slot has a control byte that is either EMPTY, DELETED, or FILLED with the low 7 bits of the hash value of its element. The control array is followed by a copy of its first GROUP-1 bytes, so that a group starting near the end of the table can be loaded without wrapping around. It is allocated with calloc since EMPTY is zero, which lets the system hand out zeroed pages lazily instead of the rehash clearing a large array in one call
+// O(1)
+static void initTable(struct table *tp, int length)
+{
+	tp->data=malloc(sizeof(void*)*length);
+	assert(tp->data!=NULL);
+	tp->hashes=malloc(sizeof(unsigned)*length);
+	assert(tp->hashes!=NULL);
+	tp->ctrl=calloc(length+GROUP-1, sizeof(unsigned char));
+	assert(tp->ctrl!=NULL);
+	tp->length=length;
+	tp->count=0;
+	tp->deleted=0;
+}
+
+// Frees up the arrays of a table and marks it as unused
+// O(1)
+static void freeTable(struct table *tp)
+{
+	free(tp->data);
+	free(tp->hashes);
+	free(tp->ctrl);
+	tp->data=NULL;
+	tp->hashes=NULL;
+	tp->ctrl=NULL;
+}
+
+// Private search function that finds the element pointed to by void *elt in the table pointed to by tp. The home hashing address and the 7-bit tag are both taken from the mixed hash value. The table is probed a group of GROUP slots at a time: the control bytes of the whole group are compared with the tag at once, and the compare function is only called for the slots whose tag and stored hash value both match, so the element pointers of other slots are never followed. The first EMPTY or DELETED slot seen is noted in case the element ends up not being in the table, so that it can be returned as the slot for an insertion. The search stops at the first group that has an EMPTY slot, since the element would have been placed there or earlier. Each group after the first is found by moving a step forward, where the step is given by firstStep and grows by a group after every move in quadratic mode
+// O(1) expected
+static int search(SET *sp, struct table *tp, void *elt, unsigned hash, bool *found)
 {
 	assert(sp!=NULL && elt!=NULL);
-	int i, idx, delidx;
-	int delFlag=0;
-	unsigned hash = (*sp->hash)(elt);
+	int i, idx, freeidx=-1;
+	unsigned bits, mask=tp->length-1;
+	unsigned pos=(hash>>7)&mask, step=firstStep(sp, hash);
+	unsigned char tag=FILLED|(hash&0x7F), *group;
 	*found = false;
-	for(i=0;i<sp->length;i++)
+	for(i=0;i<tp->length;i+=GROUP)
 	{
-		idx=(hash+i)%(sp->length);
-		if(sp->flags[idx]==EMPTY)
+		group=tp->ctrl+pos;
+		for(bits=matchTag(group, tag); bits!=0; bits&=bits-1)
 		{
-			if(delFlag==1)
-				return delidx;
-			else
-				return idx;
-		}
-		else if(sp->flags[idx]==FILLED)
-		{
-			if((*sp->compare)(sp->data[idx],elt)==0)
+			idx=(pos+__builtin_ctz(bits))&mask;
+			if(tp->hashes[idx]==hash && COMPARE(sp, tp->data[idx], elt)==0)
 			{
 				*found=true;
 				return idx;
 			}
 		}
-		else
+		bits=matchFree(group);
+		if(freeidx==-1 && bits!=0)
+			freeidx=(pos+__builtin_ctz(bits))&mask;
+		if(matchEmpty(group)!=0)
+			break;
+		pos=(pos+step)&mask;
+		if(sp->probe==SET_QUADRATIC)
+			step+=GROUP;
+	}
+	return freeidx;
+}
+
+// Private search function that checks the current table and then the part of the old table that has not been migrated yet. If the element is found, *tpp is set to the table that holds it and its index is returned. Otherwise, the index of the slot in the current table where it should be inserted is returned
+// O(1) expected
+static int locate(SET *sp, void *elt, unsigned hash, struct table **tpp, bool *found)
+{
+	int idx, oldidx;
+	*tpp=&sp->cur;
+	idx=search(sp, &sp->cur, elt, hash, found);
+	if(*found==false && sp->old.data!=NULL)
+	{
+		oldidx=search(sp, &sp->old, elt, hash, found);
+		if(*found==true)
+		{
+			*tpp=&sp->old;
+			return oldidx;
+		}
+	}
+	return idx;
+}
+
+// Inserts the element into the free slot idx of the current table, which was found by locate, and returns the address of the slot; If the load factor would be crossed, the table is grown first and the slot is found again. Afterwards, a few slots of a pending rehash are migrated, so that the rehash is spread over many insertions. Since the migration only happens when the set actually changes, the layout of the table depends only on the sequence of insertions and removals
+// O(1) expected
+static void **insert(SET *sp, int idx, void *elt, unsigned hash)
+{
+	bool found;
+	if(sp->cur.count+sp->cur.deleted>=MAX_LOAD(sp->cur.length))
+	{
+		grow(sp);
+		idx=search(sp, &sp->cur, elt, hash, &found);
+	}
+	place(&sp->cur, idx, elt, hash);
+	if(sp->filter!=NULL)
+		addFilter(sp, hash);
+	migrate(sp, MIGRATE_SLOTS);
+	return &sp->cur.data[idx];
+}
+
+// Removes the element in slot idx of the table pointed to by tp; The slot is set back to EMPTY if no search can have probed past it, and is otherwise marked DELETED so that the probe sequences passing through it are not broken. Like insert, it then migrates a few slots of a pending rehash. Once the DELETED slots of the current table pass a threshold, a rehash is started to clear them out, so that searches under heavy churn do not get longer over time. The bits of a removed element cannot be cleared from a Bloom filter, since other elements may share them, so once more elements have been removed since the filter was built than are left in the set, a rehash is started as well, which builds a fresh filter as it migrates
+// O(1) expected
+static void erase(SET *sp, struct table *tp, int idx)
+{
+	if(canEmpty(tp, idx))
+		setCtrl(tp, idx, EMPTY);
+	else
+	{
+		setCtrl(tp, idx, DELETED);
+		tp->deleted++;
+	}
+	tp->count--;
+	migrate(sp, MIGRATE_SLOTS);
+	if(sp->filter!=NULL)
+		sp->stale++;
+	if(sp->old.data==NULL && (sp->cur.deleted>MAX_DELETED(sp->cur.length) || (sp->filter!=NULL && sp->stale>MAX_STALE(numElements(sp)))))
+		grow(sp);
+}
+
+// Stores the element and its hash value in the free slot idx of the table pointed to by tp and sets its control byte to the tag of its hash value
+// O(1)
+static void place(struct table *tp, int idx, void *elt, unsigned hash)
+{
+	if(tp->ctrl[idx]==DELETED)
+		tp->deleted--;
+	tp->data[idx]=elt;
+	tp->hashes[idx]=hash;
+	setCtrl(tp, idx, FILLED|(hash&0x7F));
+	tp->count++;
+}
+
+// Sets the control byte of slot idx, along with its copy past the end of the control array if it is one of the first GROUP-1 slots
+// O(1)
+static void setCtrl(struct table *tp, int idx, unsigned char c)
+{
+	tp->ctrl[idx]=c;
+	if(idx<GROUP-1)
+		tp->ctrl[tp->length+idx]=c;
+}
+
+// Returns true if every group of GROUP slots that contains slot idx also contains an EMPTY slot. Since a search stops at the first group with an EMPTY slot, no search can then have probed past idx, so the slot can be set back to EMPTY instead of DELETED when its element is removed. The EMPTY slots just before and just after idx are found with one group each, and the run of non-EMPTY slots between them must be shorter than a group
+// O(1)
+static bool canEmpty(struct table *tp, int idx)
+{
+	unsigned before=matchEmpty(tp->ctrl+((idx-GROUP)&(tp->length-1)));
+	unsigned after=matchEmpty(tp->ctrl+idx);
+	if(before==0 || after==0)
+		return false;
+	return __builtin_clz(before<<(32-GROUP))+__builtin_ctz(after)<GROUP;
+}
+
+// Moves up to the given number of slots from the old table into the current table, in index order. The stored hash values are reused, so the hash function is not called again. A moved slot is marked DELETED rather than EMPTY, so the probe sequences of the elements that are still in the old table stay intact. Each moved element is also added to the Bloom filter being built by startFilter, if there is one. Once every slot has been moved, the old table is freed and the new filter takes the place of the current one, since it then holds every element
+// O(slots)
+static void migrate(SET *sp, int slots)
+{
+	int idx;
+	bool found;
+	unsigned hash;
+	struct table *old=&sp->old;
+	if(old->data==NULL)
+		return;
+	while(slots-->0 && sp->migrated<old->length)
+	{
+		if(old->ctrl[sp->migrated]&FILLED)
+		{
+			void *elt=old->data[sp->migrated];
+			hash=old->hashes[sp->migrated];
+			idx=search(sp, &sp->cur, elt, hash, &found);
+			place(&sp->cur, idx, elt, hash);
+			if(sp->nextFilter!=NULL)
+				setBits(nextBlock(sp, hash), hash);
+			setCtrl(old, sp->migrated, DELETED);
+			old->count--;
+		}
+		sp->migrated++;
+	}
+	if(sp->migrated==old->length)
+	{
+		freeTable(old);
+		if(sp->nextFilter!=NULL)
+		{
+			free(sp->filter);
+			sp->filter=sp->nextFilter;
+			sp->blocks=sp->nextBlocks;
+			sp->nextFilter=NULL;
+		}
+	}
+}
+
+// Starts a rehash: the current table becomes the old table and a new, empty current table is allocated. The new table is twice as large unless fewer than half of the slots hold elements, in which case it keeps the same size and the rehash only clears out the DELETED slots. A Bloom filter for the length of the new table is started by startFilter and filled in by migrate, so it is never rebuilt all at once. Any rehash still in progress is finished first, which cannot normally happen since each mutation migrates more slots than it can fill
+// O(n) to allocate, O(1) per element to migrate
+static void grow(SET *sp)
+{
+	int length=sp->cur.length;
+	if(sp->old.data!=NULL)
+		migrate(sp, sp->old.length);
+	if(sp->cur.count>=length/2)
+		length*=2;
+	sp->old=sp->cur;
+	sp->migrated=0;
+	initTable(&sp->cur, length);
+	if(sp->filter!=NULL)
+		startFilter(sp, length);
+}
+
+// Computes the mixed hash values of the n elements of the array elts into the array hashes and prefetches what the searches for them will touch, in two passes over the batch. The first pass prefetches the home group of each element with prefetchHome, and by the time the second pass comes back to an element, its control bytes have had the rest of the batch to arrive, so prefetchMatches can match them against the tag. Prefetching is only a hint, so an element whose table grows before it is searched for is still found correctly
+// O(n)
+static void prefetch(SET *sp, void **elts, int n, unsigned *hashes)
+{
+	int i;
+	for(i=0;i<n;i++)
+	{
+		hashes[i]=mix((*sp->hash)(elts[i]));
+		prefetchHome(sp, hashes[i]);
+	}
+	prefetchMatches(sp, n, hashes);
+}
+
+// Prefetches the control bytes, stored hash values, and element pointers of the home group of the hash value in the current table, along with its block of the Bloom filter if there is one
+// O(1)
+static void prefetchHome(SET *sp, unsigned hash)
+{
+	struct table *tp=&sp->cur;
+	unsigned pos=(hash>>7)&(tp->length-1);
+	__builtin_prefetch(tp->ctrl+pos);
+	__builtin_prefetch(tp->hashes+pos);
+	__builtin_prefetch(tp->data+pos);
+	if(sp->filter!=NULL)
+		__builtin_prefetch(filterBlock(sp, hash));
+}
+
+// Matches the home group of each of the n hash values in the array hashes against its tag and prefetches the element that the first candidate slot points to, since the compare function will follow that pointer
+// O(n)
+static void prefetchMatches(SET *sp, int n, unsigned *hashes)
+{
+	int i;
+	unsigned pos, bits, mask=sp->cur.length-1;
+	struct table *tp=&sp->cur;
+	for(i=0;i<n;i++)
+	{
+		pos=(hashes[i]>>7)&mask;
+		bits=matchTag(tp->ctrl+pos, FILLED|(hashes[i]&0x7F));
+		if(bits!=0)
+			__builtin_prefetch(tp->data[(pos+__builtin_ctz(bits))&mask]);
+	}
+}
+
+// Returns a copy of the set that shares its elements, made by copying the arrays of its tables and its Bloom filter as they are, so that no element is hashed or searched for. A rehash in progress carries on in the copy from where it was
+// O(n)
+static SET *cloneSet(SET *sp)
+{
+	SET *copy=malloc(sizeof(SET));
+	assert(copy!=NULL);
+	*copy=*sp;
+	copyTable(&copy->cur, &sp->cur);
+	if(sp->old.data!=NULL)
+		copyTable(&copy->old, &sp->old);
+	if(sp->filter!=NULL)
+	{
+		copy->filter=aligned_alloc(sizeof(uint32_t)*BLOOM_WORDS, sizeof(uint32_t)*BLOOM_WORDS*sp->blocks);
+		assert(copy->filter!=NULL);
+		memcpy(copy->filter, sp->filter, sizeof(uint32_t)*BLOOM_WORDS*sp->blocks);
+	}
+	if(sp->nextFilter!=NULL)
+	{
+		copy->nextFilter=aligned_alloc(sizeof(uint32_t)*BLOOM_WORDS, sizeof(uint32_t)*BLOOM_WORDS*sp->nextBlocks);
+		assert(copy->nextFilter!=NULL);
+		memcpy(copy->nextFilter, sp->nextFilter, sizeof(uint32_t)*BLOOM_WORDS*sp->nextBlocks);
+	}
+#ifdef SET_STATS
+	copy->compares=0;
+#endif
+	return copy;
+}
+
+// Allocates the table pointed to by tp with the length of the table pointed to by from and copies its slots, control bytes, and counts
+// O(n)
+static void copyTable(struct table *tp, struct table *from)
+{
+	initTable(tp, from->length);
+	memcpy(tp->data, from->data, sizeof(void*)*from->length);
+	memcpy(tp->hashes, from->hashes, sizeof(unsigned)*from->length);
+	memcpy(tp->ctrl, from->ctrl, from->length+GROUP-1);
+	tp->count=from->count;
+	tp->deleted=from->deleted;
+}
+
+// Walks the slots of the set walked and looks up each of its elements in the set probed, keeping the elements that are found if keep is true and those that are not found otherwise, along with their stored hash values. If probedElts is true, the element kept for one that is found is the equal element of the set probed. Neither set is changed, since lookups never migrate slots, so when the set walked has at least PASS_SLOTS slots for each, its slots are split into ranges that are walked by threads of their own, one for each processor up to MAX_THREADS. The compare calls are only counted with a single thread. Each range is filled into its own entry of the array passes, and the number of ranges is returned
+// O(n) expected
+static int walk(SET *walked, SET *probed, bool keep, bool probedElts, struct pass *passes)
+{
+	int i, t=1, slots=walked->cur.length;
+	pthread_t tids[MAX_THREADS];
+	if(walked->old.data!=NULL)
+		slots+=walked->old.length;
+#ifndef SET_STATS
+	t=sysconf(_SC_NPROCESSORS_ONLN);
+	if(t>MAX_THREADS)
+		t=MAX_THREADS;
+	if(t>slots/PASS_SLOTS)
+		t=slots/PASS_SLOTS;
+	if(t<1)
+		t=1;
+#endif
+	for(i=0;i<t;i++)
+	{
+		passes[i].walked=walked;
+		passes[i].probed=probed;
+		passes[i].start=(long)slots*i/t;
+		passes[i].end=(long)slots*(i+1)/t;
+		passes[i].keep=keep;
+		passes[i].probedElts=probedElts;
+		passes[i].elts=NULL;
+		passes[i].hashes=NULL;
+		passes[i].count=0;
+		passes[i].size=0;
+	}
+	if(t==1)
+		walkRange(&passes[0]);
+	else
+	{
+		for(i=0;i<t;i++)
+			pthread_create(&tids[i], NULL, walkRange, &passes[i]);
+		for(i=0;i<t;i++)
+			pthread_join(tids[i], NULL);
+	}
+	return t;
+}
+
+// Walks one range of slots for walk, whose index runs over the current table and then over the old table as in nextElement. The elements are gathered BATCH_SIZE at a time with the hash values stored next to them, so the hash function is never called, and the home group of each is prefetched from the set probed as it is gathered, before any of the batch is looked up
+// O(n) expected
+static void *walkRange(void *arg)
+{
+	struct pass *pp=arg;
+	struct table *tp, *from;
+	void *elts[BATCH_SIZE];
+	unsigned hashes[BATCH_SIZE];
+	int i, j, m, idx;
+	bool found;
+	for(i=pp->start;i<pp->end;)
+	{
+		for(m=0;m<BATCH_SIZE && i<pp->end;i++)
 		{
-			if(delFlag==0)
+			from=i<pp->walked->cur.length ? &pp->walked->cur : &pp->walked->old;
+			idx=from==&pp->walked->cur ? i : i-pp->walked->cur.length;
+			if(from->ctrl[idx]&FILLED)
 			{
-				delFlag=1;
-				delidx=idx;
+				elts[m]=from->data[idx];
+				hashes[m]=from->hashes[idx];
+				prefetchHome(pp->probed, hashes[m++]);
 			}
 		}
-	}	
-	return idx;
+		prefetchMatches(pp->probed, m, hashes);
+		for(j=0;j<m;j++)
+		{
+			found=false;
+			if(pp->probed->filter==NULL || maybeContains(pp->probed, hashes[j]))
+				idx=locate(pp->probed, elts[j], hashes[j], &tp, &found);
+			if(found==pp->keep)
+				keepElement(pp, found && pp->probedElts ? tp->data[idx] : elts[j], hashes[j]);
+		}
+	}
+	return NULL;
+}
+
+// Appends the element and its hash value to the arrays of the range pointed to by pp, which double in size as they fill up
+// O(1) amortized
+static void keepElement(struct pass *pp, void *elt, unsigned hash)
+{
+	if(pp->count==pp->size)
+	{
+		pp->size=pp->size>0 ? pp->size*2 : BATCH_SIZE;
+		pp->elts=realloc(pp->elts, sizeof(void*)*pp->size);
+		pp->hashes=realloc(pp->hashes, sizeof(unsigned)*pp->size);
+		assert(pp->elts!=NULL && pp->hashes!=NULL);
+	}
+	pp->elts[pp->count]=elt;
+	pp->hashes[pp->count++]=hash;
+}
+
+// Adds each of the n elements of the array elts to the set as addElements does, except that their mixed hash values are taken from the array hashes instead of being computed. If replace is true, an element that the set already holds an equal element for takes the place of that element
+// O(n) expected
+static void addHashed(SET *sp, void **elts, unsigned *hashes, int n, bool replace)
+{
+	int i, j, m, idx;
+	bool found;
+	struct table *tp;
+	for(i=0;i<n;i+=BATCH_SIZE)
+	{
+		m=n-i<BATCH_SIZE ? n-i : BATCH_SIZE;
+		for(j=0;j<m;j++)
+			prefetchHome(sp, hashes[i+j]);
+		prefetchMatches(sp, m, hashes+i);
+		for(j=0;j<m;j++)
+		{
+			idx=locate(sp, elts[i+j], hashes[i+j], &tp, &found);
+			if(found==false)
+				insert(sp, idx, elts[i+j], hashes[i+j]);
+			else if(replace==true)
+				tp->data[idx]=elts[i+j];
+		}
+	}
+}
+
+// Adds each element of the set from to the set sp with its stored hash value, replacing the equal element if sp already holds one, so that the elements of from are the ones kept. The elements are gathered BATCH_SIZE at a time from the current table and then the old one, as in walkRange, and added by addHashed
+// O(n) expected
+static void mergeSet(SET *sp, SET *from)
+{
+	void *elts[BATCH_SIZE];
+	unsigned hashes[BATCH_SIZE];
+	struct table *tp;
+	int i, idx, m=0, slots=from->cur.length;
+	if(from->old.data!=NULL)
+		slots+=from->old.length;
+	for(i=0;i<slots;i++)
+	{
+		tp=i<from->cur.length ? &from->cur : &from->old;
+		idx=tp==&from->cur ? i : i-from->cur.length;
+		if(tp->ctrl[idx]&FILLED)
+		{
+			elts[m]=tp->data[idx];
+			hashes[m++]=tp->hashes[idx];
+		}
+		if(m==BATCH_SIZE || (i==slots-1 && m>0))
+		{
+			addHashed(sp, elts, hashes, m, true);
+			m=0;
+		}
+	}
+}
+
+// Removes each of the n elements of the array elts from the set as removeElement does, with their mixed hash values taken from the array hashes, and with the home groups of a batch prefetched as in addHashed
+// O(n) expected
+static void removeHashed(SET *sp, void **elts, unsigned *hashes, int n)
+{
+	int i, j, m, idx;
+	bool found;
+	struct table *tp;
+	for(i=0;i<n;i+=BATCH_SIZE)
+	{
+		m=n-i<BATCH_SIZE ? n-i : BATCH_SIZE;
+		for(j=0;j<m;j++)
+			prefetchHome(sp, hashes[i+j]);
+		prefetchMatches(sp, m, hashes+i);
+		for(j=0;j<m;j++)
+		{
+			idx=locate(sp, elts[i+j], hashes[i+j], &tp, &found);
+			if(found==true)
+				erase(sp, tp, idx);
+		}
+	}
+}
+
+// Allocates a Bloom filter with one byte for each slot of a table of the given length, all clear. The filter is split into blocks of BLOOM_WORDS 32-bit words, which are aligned so that no block crosses a cache line
+// O(n)
+static void initFilter(SET *sp, int length)
+{
+	free(sp->filter);
+	sp->blocks=length/32>0 ? length/32 : 1;
+	sp->filter=aligned_alloc(sizeof(uint32_t)*BLOOM_WORDS, sizeof(uint32_t)*BLOOM_WORDS*sp->blocks);
+	assert(sp->filter!=NULL);
+	memset(sp->filter, 0, sizeof(uint32_t)*BLOOM_WORDS*sp->blocks);
+	sp->stale=0;
+}
+
+// Allocates a clear Bloom filter sized for a table of the given length, which takes the place of the current filter once the rehash that grow has just started is done. Until then, lookups keep using the current filter, addFilter sets the bits of an added element in both filters, and migrate adds the elements of the old table to the new filter as it moves them. The new filter holds no removed elements, so the count of removals starts over
+// O(n) to allocate
+static void startFilter(SET *sp, int length)
+{
+	sp->nextBlocks=length/32>0 ? length/32 : 1;
+	sp->nextFilter=aligned_alloc(sizeof(uint32_t)*BLOOM_WORDS, sizeof(uint32_t)*BLOOM_WORDS*sp->nextBlocks);
+	assert(sp->nextFilter!=NULL);
+	memset(sp->nextFilter, 0, sizeof(uint32_t)*BLOOM_WORDS*sp->nextBlocks);
+	sp->stale=0;
+}
+
+// Returns the block of the Bloom filter for the given mixed hash value, which is picked by the hash value mixed again with a different seed, so that it does not depend on the same bits as the home slot
+// O(1)
+static uint32_t *filterBlock(SET *sp, unsigned hash)
+{
+	return sp->filter+(mix(hash^BLOOM_SEED)&(sp->blocks-1))*BLOOM_WORDS;
+}
+
+// Returns the block of the Bloom filter being built by startFilter for the given mixed hash value, picked as in filterBlock
+// O(1)
+static uint32_t *nextBlock(SET *sp, unsigned hash)
+{
+	return sp->nextFilter+(mix(hash^BLOOM_SEED)&(sp->nextBlocks-1))*BLOOM_WORDS;
+}
+
+// Adds the given mixed hash value to the Bloom filter, and to the filter being built by startFilter if there is one
+// O(1)
+static void addFilter(SET *sp, unsigned hash)
+{
+	setBits(filterBlock(sp, hash), hash);
+	if(sp->nextFilter!=NULL)
+		setBits(nextBlock(sp, hash), hash);
+}
+
+// Adds the given mixed hash value to the block of a Bloom filter pointed to by bp by setting one bit in each word of the block. The bit in each word is picked by the top five bits of the hash value times an odd constant of its own, as in a split block Bloom filter
+// O(1)
+static void setBits(uint32_t *bp, unsigned hash)
+{
+	int i;
+	for(i=0;i<BLOOM_WORDS;i++)
+		bp[i]|=1u<<((hash*salts[i])>>27);
+}
+
+// Returns false if the given mixed hash value is definitely not in the Bloom filter, that is, if any of its bits is clear, or true if it may be. Only one block of the filter is read
+// O(1)
+static bool maybeContains(SET *sp, unsigned hash)
+{
+	int i;
+	uint32_t *bp=filterBlock(sp, hash);
+	for(i=0;i<BLOOM_WORDS;i++)
+		if(!(bp[i]&(1u<<((hash*salts[i])>>27))))
+			return false;
+	return true;
+}
+
+// Adds the slots, tombstones, and probe lengths of the table pointed to by tp to the statistics pointed to by stats. A miss from each home slot is taken to follow the probe sequence of a hash value with that home slot and no other bits set. If before is not NULL, every search misses in the table it points to first. The probes to find are left as a total for getSetStats to average, and the most probes to miss is the longer of the misses of the two tables, since the longest misses in each are not those of the same element
+// O(n)
+static void tableStats(SET *sp, struct table *tp, struct table *before, STATS *stats)
+{
+	int i, probes, most=0;
+	double total=0;
+	for(i=0;i<tp->length;i++)
+	{
+		probes=missGroups(sp, tp, i<<7);
+		total+=probes;
+		if(probes>most)
+			most=probes;
+		if(tp->ctrl[i]&FILLED)
+		{
+			probes=hitGroups(sp, tp, i);
+			if(before!=NULL)
+				probes+=missGroups(sp, before, tp->hashes[i]);
+			stats->hitProbes+=probes;
+			if(probes>stats->maxHit)
+				stats->maxHit=probes;
+			stats->histogram[probes<SET_HISTOGRAM ? probes : SET_HISTOGRAM-1]++;
+		}
+	}
+	stats->length+=tp->length;
+	stats->deleted+=tp->deleted;
+	stats->missProbes+=total/tp->length;
+	if(most>stats->maxMiss)
+		stats->maxMiss=most;
+}
+
+// Returns the number of groups that a search of the table pointed to by tp for an element with the given mixed hash value reads before it reaches a group with an EMPTY slot, which is the number of probes for a miss
+// O(1) expected
+static int missGroups(SET *sp, struct table *tp, unsigned hash)
+{
+	int n=1;
+	unsigned mask=tp->length-1;
+	unsigned pos=(hash>>7)&mask, step=firstStep(sp, hash);
+	while(n*GROUP<tp->length && matchEmpty(tp->ctrl+pos)==0)
+	{
+		pos=(pos+step)&mask;
+		if(sp->probe==SET_QUADRATIC)
+			step+=GROUP;
+		n++;
+	}
+	return n;
+}
+
+// Returns the number of groups that a search of the table pointed to by tp reads to find the element in slot idx, which is the position in its probe sequence of the first group that holds the slot
+// O(1) expected
+static int hitGroups(SET *sp, struct table *tp, int idx)
+{
+	int n=1;
+	unsigned mask=tp->length-1;
+	unsigned pos=(tp->hashes[idx]>>7)&mask, step=firstStep(sp, tp->hashes[idx]);
+	while(((idx-pos)&mask)>=GROUP)
+	{
+		pos=(pos+step)&mask;
+		if(sp->probe==SET_QUADRATIC)
+			step+=GROUP;
+		n++;
+	}
+	return n;
+}
+
+// Returns the distance from the first group that a search for an element with the given mixed hash value reads to the second. It is a single group for linear and quadratic probing. For double hashing, it is an odd number of groups taken from the hash value mixed again with a different seed, so that elements with the same home slot still follow different sequences; Since the number of groups in the table is a power of two, an odd step reaches every group before coming back to the first, and so do the triangular offsets of quadratic probing
+// O(1)
+static unsigned firstStep(SET *sp, unsigned hash)
+{
+	if(sp->probe==SET_DOUBLE)
+		return (mix(hash^DOUBLE_SEED)|1)*GROUP;
+	return GROUP;
+}
+
+// Mixes the bits of the hash value given by the interface, since the low bits pick the tag and the high bits pick the home slot of a power-of-two table; This is the finalizer of MurmurHash3
+// O(1)
+static unsigned mix(unsigned hash)
+{
+	hash^=hash>>16;
+	hash*=0x85ebca6b;
+	hash^=hash>>13;
+	hash*=0xc2b2ae35;
+	hash^=hash>>16;
+	return hash;
+}
+
+#ifdef __SSE2__
+
+// Returns a bit mask of the slots in the group whose control byte equals the tag, comparing all GROUP bytes at once
+// O(1)
+static unsigned matchTag(unsigned char *group, unsigned char tag)
+{
+	__m128i ctrl=_mm_loadu_si128((__m128i *)group);
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(tag)));
+}
+
+// Returns a bit mask of the EMPTY slots in the group
+// O(1)
+static unsigned matchEmpty(unsigned char *group)
+{
+	__m128i ctrl=_mm_loadu_si128((__m128i *)group);
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_setzero_si128()));
+}
+
+// Returns a bit mask of the EMPTY or DELETED slots in the group, which are exactly the slots whose control byte has its high bit clear
+// O(1)
+static unsigned matchFree(unsigned char *group)
+{
+	__m128i ctrl=_mm_loadu_si128((__m128i *)group);
+	return ~_mm_movemask_epi8(ctrl)&0xFFFF;
+}
+
+#else
+
+// Returns a bit mask of the slots in the group whose control byte equals the tag
+// O(1)
+static unsigned matchTag(unsigned char *group, unsigned char tag)
+{
+	int i;
+	unsigned bits=0;
+	for(i=0;i<GROUP;i++)
+		if(group[i]==tag)
+			bits|=1u<<i;
+	return bits;
+}
+
+// Returns a bit mask of the EMPTY slots in the group
+// O(1)
+static unsigned matchEmpty(unsigned char *group)
+{
+	return matchTag(group, EMPTY);
+}
+
+// Returns a bit mask of the EMPTY or DELETED slots in the group
+// O(1)
+static unsigned matchFree(unsigned char *group)
+{
+	int i;
+	unsigned bits=0;
+	for(i=0;i<GROUP;i++)
+		if(!(group[i]&FILLED))
+			bits|=1u<<i;
+	return bits;
 }
 
+#endif
@@ -0,0 +1,345 @@
+/*
+ * File:        typedset.h
+ *
+ * Description: This file contains a generator for sets that are
+ *              specialized to one type of element.  The expansion of
+ *
+ *                  DEFINE_SET(name, type, hash, equal)
+ *
+ *              defines a type called name, for a set of elements of the
+ *              given type, along with the functions createname,
+ *              destroyname, numnameElements, addnameElement,
+ *              removenameElement, findnameElement, and
+ *              findOrAddnameElement.  Elements are stored by value, so a
+ *              set of integers holds the integers themselves.  The hash
+ *              function returns an unsigned hash value of an element and
+ *              the equal function returns true if two elements are equal.
+ *              Both are called directly rather than through pointers, so
+ *              a hash or equal function that is defined inline, or a
+ *              macro, is compiled into the probe loop.
+ *
+ *              The table is laid out as in table.c, with control bytes
+ *              probed a group at a time and the full hash values stored
+ *              alongside the elements, except that the table is rehashed
+ *              all at once when it grows rather than incrementally.  The
+ *              set abstract data type of set.h is unchanged, and is still
+ *              the one to use when the type of the elements is only known
+ *              at run time.
+ */
+
+# ifndef TYPEDSET_H
+# define TYPEDSET_H
+
+# include <assert.h>
+# include <stdlib.h>
+# include <stdbool.h>
+# ifdef __SSE2__
+# include <emmintrin.h>
+# endif
+
+# define TS_EMPTY	0
+# define TS_DELETED	1
+# define TS_FILLED	0x80
+# define TS_GROUP	16
+# define TS_MIN_LENGTH	16
+# define TS_MAX_LOAD(n)	((n) / 8 * 7)
+
+
+/*
+ * Function:    tsMix
+ *
+ * Description: Mix the bits of a hash value with the finalizer of
+ *              MurmurHash3, since the low bits pick the tag and the high
+ *              bits pick the home slot.
+ */
+
+static inline unsigned tsMix(unsigned hash)
+{
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+
+# ifdef __SSE2__
+
+/*
+ * Function:    tsMatchTag
+ *
+ * Description: Return a bit mask of the slots in a group whose control
+ *              byte equals TAG.
+ */
+
+static inline unsigned tsMatchTag(unsigned char *group, unsigned char tag)
+{
+    __m128i ctrl = _mm_loadu_si128((__m128i *) group);
+
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(tag)));
+}
+
+
+/*
+ * Function:    tsMatchFree
+ *
+ * Description: Return a bit mask of the EMPTY or DELETED slots in a
+ *              group, which are those whose control byte has its high bit
+ *              clear.
+ */
+
+static inline unsigned tsMatchFree(unsigned char *group)
+{
+    __m128i ctrl = _mm_loadu_si128((__m128i *) group);
+
+    return ~_mm_movemask_epi8(ctrl) & 0xFFFF;
+}
+
+# else
+
+static inline unsigned tsMatchTag(unsigned char *group, unsigned char tag)
+{
+    unsigned bits = 0;
+    int i;
+
+
+    for (i = 0; i < TS_GROUP; i ++)
+	if (group[i] == tag)
+	    bits |= 1u << i;
+
+    return bits;
+}
+
+static inline unsigned tsMatchFree(unsigned char *group)
+{
+    unsigned bits = 0;
+    int i;
+
+
+    for (i = 0; i < TS_GROUP; i ++)
+	if (!(group[i] & TS_FILLED))
+	    bits |= 1u << i;
+
+    return bits;
+}
+
+# endif
+
+
+/*
+ * Function:    tsSetCtrl
+ *
+ * Description: Set the control byte of slot IDX, along with its copy past
+ *              the end of the control array if it is one of the first
+ *              TS_GROUP-1 slots.
+ */
+
+static inline void tsSetCtrl(unsigned char *ctrl, int length, int idx,
+			     unsigned char c)
+{
+    ctrl[idx] = c;
+
+    if (idx < TS_GROUP - 1)
+	ctrl[length + idx] = c;
+}
+
+
+/*
+ * Function:    tsCanEmpty
+ *
+ * Description: Return true if every group that contains slot IDX also
+ *              contains an EMPTY slot, in which case no search can have
+ *              probed past IDX and the slot can be set back to EMPTY when
+ *              its element is removed.
+ */
+
+static inline bool tsCanEmpty(unsigned char *ctrl, int length, int idx)
+{
+    unsigned before, after;
+
+
+    before = tsMatchTag(ctrl + ((idx - TS_GROUP) & (length - 1)), TS_EMPTY);
+    after = tsMatchTag(ctrl + idx, TS_EMPTY);
+
+    if (before == 0 || after == 0)
+	return false;
+
+    return __builtin_clz(before << (32 - TS_GROUP)) + __builtin_ctz(after)
+	< TS_GROUP;
+}
+
+
+# define DEFINE_SET(name, type, hash, equal)                                  \
+                                                                              \
+typedef struct name {                                                         \
+    type *data;			/* elements, valid if FILLED */               \
+    unsigned *hashes;		/* mixed hash values of the elements */       \
+    unsigned char *ctrl;	/* control bytes, plus a copy of a group */   \
+    int length;			/* number of slots, a power of two */         \
+    int count;			/* number of elements */                      \
+    int deleted;		/* number of DELETED slots */                 \
+} name;                                                                       \
+                                                                              \
+static inline void init##name(name *sp, int length)                           \
+{                                                                             \
+    sp->data = malloc(sizeof(type) * length);                                 \
+    sp->hashes = malloc(sizeof(unsigned) * length);                           \
+    sp->ctrl = calloc(length + TS_GROUP - 1, sizeof(unsigned char));          \
+    assert(sp->data != NULL && sp->hashes != NULL && sp->ctrl != NULL);       \
+    sp->length = length;                                                      \
+    sp->count = 0;                                                            \
+    sp->deleted = 0;                                                          \
+}                                                                             \
+                                                                              \
+static inline name *create##name(int maxElts)                                 \
+{                                                                             \
+    int length = TS_MIN_LENGTH;                                               \
+    name *sp = malloc(sizeof(name));                                          \
+                                                                              \
+    assert(sp != NULL);                                                       \
+                                                                              \
+    while (TS_MAX_LOAD(length) < maxElts)                                     \
+	length *= 2;                                                          \
+                                                                              \
+    init##name(sp, length);                                                   \
+    return sp;                                                                \
+}                                                                             \
+                                                                              \
+static inline void destroy##name(name *sp)                                    \
+{                                                                             \
+    assert(sp != NULL);                                                       \
+    free(sp->data);                                                           \
+    free(sp->hashes);                                                         \
+    free(sp->ctrl);                                                           \
+    free(sp);                                                                 \
+}                                                                             \
+                                                                              \
+static inline int num##name##Elements(name *sp)                               \
+{                                                                             \
+    assert(sp != NULL);                                                       \
+    return sp->count;                                                         \
+}                                                                             \
+                                                                              \
+static inline int search##name(name *sp, type elt, unsigned tsHash,           \
+				 bool *found)                                 \
+{                                                                             \
+    int i, idx, freeidx = -1;                                                 \
+    unsigned bits, mask = sp->length - 1, pos = (tsHash >> 7) & mask;         \
+    unsigned char tag = TS_FILLED | (tsHash & 0x7F), *group;                  \
+                                                                              \
+    *found = false;                                                           \
+                                                                              \
+    for (i = 0; i < sp->length; i += TS_GROUP) {                              \
+	group = sp->ctrl + pos;                                               \
+                                                                              \
+	for (bits = tsMatchTag(group, tag); bits != 0; bits &= bits - 1) {    \
+	    idx = (pos + __builtin_ctz(bits)) & mask;                         \
+                                                                              \
+	    if (sp->hashes[idx] == tsHash && equal(sp->data[idx], elt)) {     \
+		*found = true;                                                \
+		return idx;                                                   \
+	    }                                                                 \
+	}                                                                     \
+                                                                              \
+	bits = tsMatchFree(group);                                            \
+                                                                              \
+	if (freeidx == -1 && bits != 0)                                       \
+	    freeidx = (pos + __builtin_ctz(bits)) & mask;                     \
+                                                                              \
+	if (tsMatchTag(group, TS_EMPTY) != 0)                                 \
+	    break;                                                            \
+                                                                              \
+	pos = (pos + TS_GROUP) & mask;                                        \
+    }                                                                         \
+                                                                              \
+    return freeidx;                                                           \
+}                                                                             \
+                                                                              \
+static inline void rehash##name(name *sp)                                     \
+{                                                                             \
+    name old = *sp;                                                           \
+    int i, idx;                                                               \
+    bool found;                                                               \
+                                                                              \
+    init##name(sp, old.count >= old.length / 2 ? old.length * 2               \
+	       : old.length);                                                 \
+                                                                              \
+    for (i = 0; i < old.length; i ++)                                         \
+	if (old.ctrl[i] & TS_FILLED) {                                        \
+	    idx = search##name(sp, old.data[i], old.hashes[i], &found);       \
+	    sp->data[idx] = old.data[i];                                      \
+	    sp->hashes[idx] = old.hashes[i];                                  \
+	    tsSetCtrl(sp->ctrl, sp->length, idx, old.ctrl[i]);                \
+	    sp->count ++;                                                     \
+	}                                                                     \
+                                                                              \
+    free(old.data);                                                           \
+    free(old.hashes);                                                         \
+    free(old.ctrl);                                                           \
+}                                                                             \
+                                                                              \
+static inline type *findOrAdd##name##Element(name *sp, type elt)              \
+{                                                                             \
+    unsigned tsHash = tsMix(hash(elt));                                       \
+    bool found;                                                               \
+    int idx;                                                                  \
+                                                                              \
+    assert(sp != NULL);                                                       \
+    idx = search##name(sp, elt, tsHash, &found);                              \
+                                                                              \
+    if (found)                                                                \
+	return &sp->data[idx];                                                \
+                                                                              \
+    if (sp->count + sp->deleted >= TS_MAX_LOAD(sp->length)) {                 \
+	rehash##name(sp);                                                     \
+	idx = search##name(sp, elt, tsHash, &found);                          \
+    }                                                                         \
+                                                                              \
+    if (sp->ctrl[idx] == TS_DELETED)                                          \
+	sp->deleted --;                                                       \
+                                                                              \
+    sp->data[idx] = elt;                                                      \
+    sp->hashes[idx] = tsHash;                                                 \
+    tsSetCtrl(sp->ctrl, sp->length, idx, TS_FILLED | (tsHash & 0x7F));        \
+    sp->count ++;                                                             \
+    return &sp->data[idx];                                                    \
+}                                                                             \
+                                                                              \
+static inline void add##name##Element(name *sp, type elt)                     \
+{                                                                             \
+    findOrAdd##name##Element(sp, elt);                                        \
+}                                                                             \
+                                                                              \
+static inline type *find##name##Element(name *sp, type elt)                   \
+{                                                                             \
+    bool found;                                                               \
+    int idx;                                                                  \
+                                                                              \
+    assert(sp != NULL);                                                       \
+    idx = search##name(sp, elt, tsMix(hash(elt)), &found);                    \
+    return found ? &sp->data[idx] : NULL;                                     \
+}                                                                             \
+                                                                              \
+static inline void remove##name##Element(name *sp, type elt)                  \
+{                                                                             \
+    bool found;                                                               \
+    int idx;                                                                  \
+                                                                              \
+    assert(sp != NULL);                                                       \
+    idx = search##name(sp, elt, tsMix(hash(elt)), &found);                    \
+                                                                              \
+    if (!found)                                                               \
+	return;                                                               \
+                                                                              \
+    if (tsCanEmpty(sp->ctrl, sp->length, idx))                                \
+	tsSetCtrl(sp->ctrl, sp->length, idx, TS_EMPTY);                       \
+    else {                                                                    \
+	tsSetCtrl(sp->ctrl, sp->length, idx, TS_DELETED);                     \
+	sp->deleted ++;                                                       \
+    }                                                                         \
+                                                                              \
+    sp->count --;                                                             \
+}
+
+# endif /* TYPEDSET_H */
@@ -11,36 +11,214 @@
  *              are inserted into the set and the counts of total words and
  *              total words in the set are printed.  If the second file is
  *              given then all words in the second file are deleted from
- *              the set and the count printed.
+ *              the set and the count printed.  The -l option prints the
+ *              words left in the set instead of the counts, and the -b
+ *              option keeps a Bloom filter in front of the set so that
+ *              most words of the second file that are not in the set are
+ *              rejected without probing.  The -q and -d options select
+ *              quadratic probing and double hashing instead of linear
+ *              probing, and the -s option prints the probe lengths and
+ *              occupancy of the set at the end.
+ *
+ *              The -a option estimates the number of distinct words with a
+ *              HyperLogLog instead of the set, in a few kilobytes of
+ *              memory and without keeping the words.  The -p option sets
+ *              its precision, with 2^precision bytes of registers.  Since
+ *              words cannot be deleted from a HyperLogLog, the words of
+ *              every file given are counted instead, each file in a
+ *              HyperLogLog of its own, and these are merged to estimate
+ *              the distinct words of all of the files together.
  */
 
 # include <stdio.h>
+# include <assert.h>
 # include <stdlib.h>
 # include <string.h>
 # include <stdbool.h>
 # include "set.h"
+# include "hll.h"
+# include "words.h"
 
 
-/* This is sufficient for the test cases in /scratch/coen12. */
+/* This is only an initial size hint; the set grows as needed. */
 
 # define MAX_SIZE 18000
 
 
+/* The number of words handed to the set at once. */
+
+# define BATCH_SIZE 64
+
+
+/* The precision of a HyperLogLog unless -p is given, for 4 KB of registers
+   and an error of about 1.6%. */
+
+# define PRECISION 12
+
+
+/*
+ * Function:    printElement
+ *
+ * Description: Print an element of the set on a line of its own.
+ */
+
+static void printElement(char *elt, FILE *fp)
+{
+    fprintf(fp, "%s\n", elt);
+}
+
+
+/*
+ * Function:    addBatch
+ *
+ * Description: Add the N words given as views in WORDS with their lengths
+ *              in LENGTHS to the set.  The words are copied together into
+ *              one buffer as strings and looked up in a single batch, and
+ *              only a word that is missing is then added, as a copy that
+ *              lasts as long as the tokenizer.  A word that is missing
+ *              twice in the batch is kept only once.
+ */
+
+static void addBatch(SET *sp, WORDS *wp, char **words, int *lengths, int n)
+{
+    char *keys[BATCH_SIZE], *found[BATCH_SIZE], **slot, *buffer;
+    int i, size;
+
+
+    for (i = 0, size = 0; i < n; i ++)
+	size += lengths[i] + 1;
+
+    buffer = malloc(size + 1);
+    assert(buffer != NULL);
+
+    for (i = 0, size = 0; i < n; i ++) {
+	keys[i] = buffer + size;
+	memcpy(keys[i], words[i], lengths[i]);
+	keys[i][lengths[i]] = '\0';
+	size += lengths[i] + 1;
+    }
+
+    findElements(sp, (void **) keys, n, (void **) found);
+
+    for (i = 0; i < n; i ++)
+	if (found[i] == NULL) {
+	    slot = (char **) findOrAddElement(sp, keys[i]);
+
+	    if (*slot == keys[i])
+		*slot = keepWord(wp, words[i], lengths[i]);
+	}
+
+    free(buffer);
+}
+
+
 /*
- * Function:    strhash
+ * Function:    printStats
  *
- * Description: Return a hash value for a string S.
+ * Description: Print the statistics of a set, as given by getSetStats.
  */
 
-static unsigned strhash(char *s)
+static void printStats(SET *sp)
 {
-    unsigned hash = 0;
+    STATS stats;
+    int i;
+
 
+    getSetStats(sp, &stats);
+    printf("%d elements in %d slots, load %.3f\n", stats.count, stats.length,
+	   stats.load);
+    printf("%d tombstones, ratio %.3f\n", stats.deleted,
+	   (double) stats.deleted / stats.length);
+    printf("probes to find: average %.3f, most %d\n", stats.hitProbes,
+	   stats.maxHit);
+    printf("probes to miss: average %.3f, most %d\n", stats.missProbes,
+	   stats.maxMiss);
 
-    while (*s != '\0')
-        hash = 31 * hash + *s ++;
+    if (stats.compares >= 0)
+	printf("%ld compare calls\n", stats.compares);
 
-    return hash;
+    printf("elements by probes to find:");
+
+    for (i = 1; i < SET_HISTOGRAM; i ++)
+	if (stats.histogram[i] > 0)
+	    printf(" %d%s=%d", i, i == SET_HISTOGRAM - 1 ? "+" : "",
+		   stats.histogram[i]);
+
+    printf("\n");
+}
+
+
+/*
+ * Function:    approximate
+ *
+ * Description: Estimate the number of distinct words in each of the N
+ *              files in PATHS with a HyperLogLog of the given precision,
+ *              and in all of them together by merging the HyperLogLogs.
+ */
+
+static void approximate(char *name, char **paths, int n, int precision)
+{
+    WORDS *wp;
+    HLL *all, *hp;
+    char *word;
+    long words, total;
+    int i, length;
+
+
+    all = createHLL(precision, hashString);
+    total = 0;
+
+    for (i = 0; i < n; i ++) {
+	if ((wp = openWords(paths[i])) == NULL) {
+	    fprintf(stderr, "%s: cannot open %s\n", name, paths[i]);
+	    exit(EXIT_FAILURE);
+	}
+
+	hp = createHLL(precision, hashString);
+	words = 0;
+
+	while ((word = nextWord(wp, &length)) != NULL) {
+	    words ++;
+	    addToHLL(hp, termWord(wp, word, length));
+	}
+
+	if (n > 1)
+	    printf("%s:\n", paths[i]);
+
+	printf("%ld total words\n", words);
+	printf("about %.0f distinct words\n", estimateDistinct(hp));
+
+	mergeHLL(all, hp);
+	total += words;
+	destroyHLL(hp);
+	closeWords(wp);
+    }
+
+    if (n > 1) {
+	printf("all files:\n");
+	printf("%ld total words\n", total);
+	printf("about %.0f distinct words\n", estimateDistinct(all));
+    }
+
+    destroyHLL(all);
+}
+
+
+/*
+ * Function:    selectProbe
+ *
+ * Description: Select the probe sequence MODE for the set, and return
+ *              false if a different one has already been selected, since
+ *              only one can be used.
+ */
+
+static bool selectProbe(int *probe, int mode)
+{
+    if (*probe != 0 && *probe != mode)
+	return false;
+
+    *probe = mode;
+    return true;
 }
 
 
@@ -52,46 +230,81 @@ static unsigned strhash(char *s)
 
 int main(int argc, char *argv[])
 {
-    FILE *fp;
-    char buffer[BUFSIZ], **elts, *word;
+    WORDS *wp1, *wp2;
+    char *word, *batch[BATCH_SIZE];
     SET *unique;
-    int i, words;
-    bool lflag = false;
+    int i, n, words, length, lengths[BATCH_SIZE], flags = 0, probe = 0, precision = PRECISION;
+    bool lflag = false, sflag = false, aflag = false, ok = true;
 
 
     /* Check usage and open the first file. */
 
-    if (argc > 1 && strcmp(argv[1], "-l") == 0) {
-	lflag = true;
+    while (argc > 1 && argv[1][0] == '-') {
+	if (strcmp(argv[1], "-l") == 0)
+	    lflag = true;
+	else if (strcmp(argv[1], "-b") == 0)
+	    flags |= SET_BLOOM;
+	else if (strcmp(argv[1], "-q") == 0)
+	    ok = selectProbe(&probe, SET_QUADRATIC) && ok;
+	else if (strcmp(argv[1], "-d") == 0)
+	    ok = selectProbe(&probe, SET_DOUBLE) && ok;
+	else if (strcmp(argv[1], "-s") == 0)
+	    sflag = true;
+	else if (strcmp(argv[1], "-a") == 0)
+	    aflag = true;
+	else if (strcmp(argv[1], "-p") == 0 && argc > 2) {
+	    precision = atoi(argv[2]);
+	    argc --;
+
+	    for (i = 1; i < argc; i ++)
+		argv[i] = argv[i + 1];
+	} else
+	    break;
+
 	argc --;
 
 	for (i = 1; i < argc; i ++)
 	    argv[i] = argv[i + 1];
     }
 
-    if (argc == 1 || argc > 3) {
-        fprintf(stderr, "usage: %s [-l] file1 [file2]\n", argv[0]);
+    if (argc == 1 || (argc > 3 && !aflag) || (aflag && (lflag || sflag)) ||
+	precision < 4 || precision > 16 || !ok) {
+        fprintf(stderr, "usage: %s [-l] [-b] [-q | -d] [-s] file1 [file2]\n", argv[0]);
+        fprintf(stderr, "       %s -a [-p precision] file...\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
-    if ((fp = fopen(argv[1], "r")) == NULL) {
+    if (aflag) {
+	approximate(argv[0], argv + 1, argc - 1, precision);
+	exit(EXIT_SUCCESS);
+    }
+
+    if ((wp1 = openWords(argv[1])) == NULL) {
         fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
         exit(EXIT_FAILURE);
     }
 
 
-    /* Insert all words into the set. */
+    /* Insert all words into the set a batch at a time.  The batch holds
+       the words as views into the file, and only the words that are new
+       to the set are copied. */
 
     words = 0;
-    unique = createSet(MAX_SIZE, strcmp, strhash);
+    n = 0;
+    unique = createSetWith(MAX_SIZE, strcmp, hashString, flags | probe);
 
-    while (fscanf(fp, "%s", buffer) == 1) {
+    while ((word = nextWord(wp1, &length)) != NULL) {
         words ++;
-	if (!findElement(unique, buffer))
-	    addElement(unique, strdup(buffer));
+	batch[n] = word;
+	lengths[n ++] = length;
+
+	if (n == BATCH_SIZE) {
+	    addBatch(unique, wp1, batch, lengths, n);
+	    n = 0;
+	}
     }
 
-    fclose(fp);
+    addBatch(unique, wp1, batch, lengths, n);
 
     if (!lflag) {
 	printf("%d total words\n", words);
@@ -102,7 +315,7 @@ int main(int argc, char *argv[])
     /* Try to open the second file. */
 
     if (argc == 3) {
-        if ((fp = fopen(argv[2], "r")) == NULL) {
+        if ((wp2 = openWords(argv[2])) == NULL) {
             fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[2]);
             exit(EXIT_FAILURE);
         }
@@ -110,31 +323,25 @@ int main(int argc, char *argv[])
 
         /* Delete all words in the second file. */
 
-        while (fscanf(fp, "%s", buffer) == 1) {
-	    if ((word = findElement(unique, buffer)) != NULL) {
-		removeElement(unique, buffer);
-		free(word);
-	    }
-	}
+        while ((word = nextWord(wp2, &length)) != NULL)
+	    removeElement(unique, termWord(wp2, word, length));
 
-	fclose(fp);
+	closeWords(wp2);
 
 	if (!lflag)
 	    printf("%d remaining words\n", numElements(unique));
     }
 
 
-    /* Print the list of words if desired. */
+    /* Print the list of words straight from the set if desired. */
 
-    if (lflag) {
-	elts = getElements(unique);
+    if (lflag)
+	forEachElement(unique, printElement, stdout);
 
-	for (i = 0; i < numElements(unique); i ++)
-	    printf("%s\n", elts[i]);
-
-	free(elts);
-    }
+    if (sflag)
+	printStats(unique);
 
     destroySet(unique);
+    closeWords(wp1);
     exit(EXIT_SUCCESS);
 }
@@ -0,0 +1,172 @@
+#include <assert.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "set.h"
+#include "wordcount.h"
+
+#define BLOCK_SIZE 65536
+
+struct range
+{
+	int fd;
+	long start;
+	long end;
+	SET *counts;
+};
+
+static void *countRange(void *arg);
+static void countWord(SET *counts, char *word, int length, long first);
+static int compareFirst(const void *p1, const void *p2);
+
+
+// Returns a hash value for an entry based on its word
+// O(n)
+unsigned hashEntry(struct entry *ep)
+{
+	return hashString(ep->word);
+}
+
+// Compares two entries by their words as in strcmp()
+// O(n)
+int compareEntries(struct entry *ep1, struct entry *ep2)
+{
+	return strcmp(ep1->word, ep2->word);
+}
+
+// Counts the words of the file open on fd with the given number of threads, and returns a set of entries with maxElts as its size hint. The file is split into byte ranges of about the same size, and each thread counts the words that start in its range into a table of its own, noting the offset at which each word is first seen. The tables of the threads are then merged by walking them in place, keeping the smallest offset of each word. Finally, the merged entries are added to a new set in the order of their first offsets, which is the order in which a serial count adds them, so the layout of the set, and thus the order of getElements, is identical to that of a serial count with the same size hint. Words are delimited by isspace() as with fscanf("%s")
+// O(n) expected, plus O(m log m) for the m distinct words
+SET *countWords(int fd, int threads, int maxElts)
+{
+	assert(fd>=0 && threads>0 && threads<=MAX_THREADS);
+	int i, n, status;
+	struct stat st;
+	struct entry **entries, **slot, *ep;
+	CURSOR c;
+	struct range ranges[MAX_THREADS];
+	pthread_t tids[MAX_THREADS];
+	SET *merged, *counts;
+	status=fstat(fd, &st);
+	assert(status==0);
+	for(i=0;i<threads;i++)
+	{
+		ranges[i].fd=fd;
+		ranges[i].start=(long)st.st_size*i/threads;
+		ranges[i].end=(long)st.st_size*(i+1)/threads;
+		ranges[i].counts=createSet(0, compareEntries, hashEntry);
+		status=pthread_create(&tids[i], NULL, countRange, &ranges[i]);
+		assert(status==0);
+	}
+	for(i=0;i<threads;i++)
+		pthread_join(tids[i], NULL);
+	merged=ranges[0].counts;
+	for(i=1;i<threads;i++)
+	{
+		beginElements(ranges[i].counts, &c);
+		while((ep=nextElement(ranges[i].counts, &c))!=NULL)
+		{
+			slot=(struct entry **)findOrAddElement(merged, ep);
+			if(*slot!=ep)
+			{
+				(*slot)->count+=ep->count;
+				free(ep->word);
+				free(ep);
+			}
+		}
+		destroySet(ranges[i].counts);
+	}
+	n=numElements(merged);
+	entries=getElements(merged);
+	destroySet(merged);
+	qsort(entries, n, sizeof(struct entry *), compareFirst);
+	counts=createSet(maxElts, compareEntries, hashEntry);
+	for(i=0;i<n;i++)
+		addElement(counts, entries[i]);
+	free(entries);
+	return counts;
+}
+
+// Thread function that counts the words starting in one range of the file. The file is read a block at a time with pread, so the threads share the file descriptor without sharing a file offset. If the byte before the range is not a space, the range starts in the middle of a word that belongs to the range before it, so that word is skipped. A word that starts in the range is read to its end even if it runs past the end of the range, and the buffer that holds it doubles in size whenever the word outgrows it, so words of any length are counted as the serial tokenizer counts them
+// O(n) expected
+static void *countRange(void *arg)
+{
+	struct range *rp=arg;
+	char block[BLOCK_SIZE], *word;
+	int i, n, length=0, size=BUFSIZ;
+	long pos=rp->start, first=0;
+	bool skip=false, done=false;
+	word=malloc(size);
+	assert(word!=NULL);
+	if(pos>0 && pread(rp->fd, block, 1, pos-1)==1 && !isspace((unsigned char)block[0]))
+		skip=true;
+	while(done==false && (n=pread(rp->fd, block, BLOCK_SIZE, pos))>0)
+	{
+		for(i=0;i<n && done==false;i++, pos++)
+		{
+			if(isspace((unsigned char)block[i]))
+			{
+				skip=false;
+				if(length>0)
+				{
+					countWord(rp->counts, word, length, first);
+					length=0;
+				}
+				if(pos>=rp->end)
+					done=true;
+			}
+			else if(skip==false && length==0 && pos>=rp->end)
+				done=true;
+			else if(skip==false)
+			{
+				if(length==0)
+					first=pos;
+				if(length==size-1)
+				{
+					size*=2;
+					word=realloc(word, size);
+					assert(word!=NULL);
+				}
+				word[length++]=block[i];
+			}
+		}
+	}
+	if(length>0)
+		countWord(rp->counts, word, length, first);
+	free(word);
+	return NULL;
+}
+
+// Increments the count of the word with the given length in the table of a thread, adding a new entry that records the offset at which the word was first seen if it is not there yet
+// O(1) expected
+static void countWord(SET *counts, char *word, int length, long first)
+{
+	struct entry e, *ep, **slot;
+	word[length]='\0';
+	e.word=word;
+	slot=(struct entry **)findOrAddElement(counts, &e);
+	if(*slot==&e)
+	{
+		ep=malloc(sizeof(struct entry));
+		assert(ep!=NULL);
+		ep->word=strdup(word);
+		assert(ep->word!=NULL);
+		ep->count=0;
+		ep->first=first;
+		*slot=ep;
+	}
+	(*slot)->count++;
+}
+
+// Compares two entries by the offsets at which their words were first seen, for qsort
+// O(1)
+static int compareFirst(const void *p1, const void *p2)
+{
+	long first1=(*(struct entry **)p1)->first;
+	long first2=(*(struct entry **)p2)->first;
+	return first1<first2 ? -1 : first1>first2;
+}
@@ -0,0 +1,29 @@
+/*
+ * File:        wordcount.h
+ *
+ * Description: This file contains the public function and type
+ *              declarations for counting the words of a file with
+ *              several threads.  The counts are kept as entries in a set
+ *              built on table.c.
+ */
+
+# ifndef WORDCOUNT_H
+# define WORDCOUNT_H
+
+# include "set.h"
+
+# define MAX_THREADS	256	/* most threads that countWords may use */
+
+struct entry {
+    char *word;
+    int count;
+    long first;
+};
+
+unsigned hashEntry(struct entry *ep);
+
+int compareEntries(struct entry *ep1, struct entry *ep2);
+
+SET *countWords(int fd, int threads, int maxElts);
+
+# endif /* WORDCOUNT_H */
@@ -0,0 +1,164 @@
+/*
+ * File:        loadbench.c
+ *
+ * Description: This file contains a benchmark for loading a set from a
+ *              snapshot instead of building it from text.
+ *
+ *              The program takes a file of words, the path of a snapshot,
+ *              and an optional maximum number of distinct words as command
+ *              line arguments.  A set is built from the words of the file
+ *              as in unique.c and written to the snapshot with saveSet.  The snapshot is then loaded back
+ *              with loadSet, which must give a set with the same elements,
+ *              and every word of the file is looked up in both sets.  The
+ *              times to build, save, load, and search are printed.  The -r
+ *              option selects Robin Hood probing instead of linear probing,
+ *              and the -i option keeps short words in the slots of the set.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <time.h>
+# include <assert.h>
+# include "set.h"
+# include "words.h"
+
+
+# define MAX_SIZE 18000
+
+
+/*
+ * Function:    now
+ *
+ * Description: Return the current time in nanoseconds.
+ */
+
+static long long now(void)
+{
+    struct timespec ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+/*
+ * Function:    search
+ *
+ * Description: Look up every word of a file in a set, which must contain
+ *              all of them, and return the time taken in nanoseconds.
+ */
+
+static long long search(SET *sp, char *path)
+{
+    WORDS *wp;
+    char *word;
+    long long start;
+    int length;
+
+
+    wp = openWords(path);
+    assert(wp != NULL);
+    start = now();
+
+    while ((word = nextWord(wp, &length)) != NULL)
+	assert(findElement(sp, termWord(wp, word, length)) != NULL);
+
+    start = now() - start;
+    closeWords(wp);
+    return start;
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    WORDS *wp;
+    char *word, *elt;
+    SET *built, *loaded;
+    CURSOR c;
+    int i, length, mode = SET_LINEAR, maxElts = MAX_SIZE;
+    long long start, build, save, load;
+
+
+    /* Check usage. */
+
+    while (argc > 1 && (strcmp(argv[1], "-r") == 0 ||
+			strcmp(argv[1], "-i") == 0)) {
+	mode |= strcmp(argv[1], "-r") == 0 ? SET_ROBIN_HOOD : SET_INLINE;
+	argc --;
+
+	for (i = 1; i < argc; i ++)
+	    argv[i] = argv[i + 1];
+    }
+
+    if (argc < 3 || argc > 4) {
+	fprintf(stderr, "usage: %s [-r] [-i] file snapshot [size]\n", argv[0]);
+	exit(EXIT_FAILURE);
+    }
+
+    if (argc == 4)
+	maxElts = atoi(argv[3]);
+
+
+    /* Build the set from the words of the file and save it. */
+
+    start = now();
+
+    if ((wp = openWords(argv[1])) == NULL) {
+	fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
+	exit(EXIT_FAILURE);
+    }
+
+    built = createSetWith(maxElts, mode);
+
+    while ((word = nextWord(wp, &length)) != NULL)
+	addElement(built, termWord(wp, word, length));
+
+    closeWords(wp);
+    build = now() - start;
+
+    start = now();
+
+    if (!saveSet(built, argv[2])) {
+	fprintf(stderr, "%s: cannot write %s\n", argv[0], argv[2]);
+	exit(EXIT_FAILURE);
+    }
+
+    save = now() - start;
+
+
+    /* Load the snapshot and check that it has the same elements. */
+
+    start = now();
+
+    if ((loaded = loadSet(argv[2])) == NULL) {
+	fprintf(stderr, "%s: cannot load %s\n", argv[0], argv[2]);
+	exit(EXIT_FAILURE);
+    }
+
+    load = now() - start;
+
+    assert(numElements(loaded) == numElements(built));
+    beginElements(built, &c);
+
+    while ((elt = nextElement(built, &c)) != NULL)
+	assert(strcmp(findElement(loaded, elt), elt) == 0);
+
+    printf("%d distinct words\n", numElements(built));
+    printf("%-8s %12.3f ms\n", "build", build / 1e6);
+    printf("%-8s %12.3f ms\n", "save", save / 1e6);
+    printf("%-8s %12.3f ms\n", "load", load / 1e6);
+    printf("%-8s %12.3f ms\n", "search", search(built, argv[1]) / 1e6);
+    printf("%-8s %12.3f ms\n", "(loaded)", search(loaded, argv[1]) / 1e6);
+
+    destroySet(built);
+    destroySet(loaded);
+    exit(EXIT_SUCCESS);
+}
@@ -9,13 +9,16 @@
  *              The program takes a single file as a command line argument.
  *              A set is used to maintain a collection of words that occur
  *              an odd number of times.  The counts of total words and
- *              words appearing an odd number of times are printed.
+ *              words appearing an odd number of times are printed.  The
+ *              -r option selects Robin Hood probing instead of linear
+ *              probing.
  */
 
 # include <stdio.h>
 # include <stdlib.h>
 # include <string.h>
 # include "set.h"
+# include "words.h"
 
 
 /* This is sufficient for the test cases in /scratch/coen12. */
@@ -31,43 +34,52 @@
 
 int main(int argc, char *argv[])
 {
-    FILE *fp;
-    char buffer[BUFSIZ];
+    WORDS *wp;
+    char *word;
     SET *odd;
-    int words;
+    int words, length, mode = SET_LINEAR;
 
 
     /* Check usage and open the file. */
 
+    if (argc == 3 && strcmp(argv[1], "-r") == 0) {
+	mode = SET_ROBIN_HOOD;
+	argc --;
+	argv[1] = argv[2];
+    }
+
     if (argc != 2) {
-        fprintf(stderr, "usage: %s file1\n", argv[0]);
+        fprintf(stderr, "usage: %s [-r] file1\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
-    if ((fp = fopen(argv[1], "r")) == NULL) {
+    if ((wp = openWords(argv[1])) == NULL) {
         fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
         exit(EXIT_FAILURE);
     }
 
 
-    /* Insert or delete words to compute their parity. */
+    /* Insert or delete words to compute their parity.  Each word is
+       given to the set as a temporary string, and the set copies only the
+       words that it adds. */
 
     words = 0;
-    odd = createSet(MAX_SIZE);
+    odd = createSetWith(MAX_SIZE, mode);
 
-    while (fscanf(fp, "%s", buffer) == 1) {
+    while ((word = nextWord(wp, &length)) != NULL) {
         words ++;
+        word = termWord(wp, word, length);
 
-        if (findElement(odd, buffer))
-            removeElement(odd, buffer);
+        if (findElement(odd, word))
+            removeElement(odd, word);
         else
-            addElement(odd, buffer);
+            addElement(odd, word);
     }
 
     printf("%d total words\n", words);
     printf("%d words occur an odd number of times\n", numElements(odd));
-    fclose(fp);
 
     destroySet(odd);
+    closeWords(wp);
     exit(EXIT_SUCCESS);
 }
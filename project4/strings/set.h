@@ -13,8 +13,44 @@
 
 typedef struct set SET;
 
+typedef struct cursor {
+    int index;			/* next slot to visit */
+} CURSOR;
+
+# define SET_LINEAR	0	/* linear probing */
+# define SET_ROBIN_HOOD	1	/* Robin Hood probing */
+# define SET_BORROW	2	/* keep the given strings instead of copies */
+# define SET_BLOOM	4	/* keep a Bloom filter for fast misses */
+# define SET_QUADRATIC	8	/* probe groups at triangular offsets */
+# define SET_DOUBLE	16	/* probe groups at a step from a second hash */
+# define SET_INLINE	32	/* keep short strings in the slots themselves */
+
+/* The statistics returned by getSetStats.  A probe is one group of slots
+   whose control bytes are read at once, or one slot in Robin Hood mode.
+   Entry i of the histogram counts the elements that take i probes to
+   find, and the last entry also counts any that take more.  The calls to
+   strcmp are only counted if the set is compiled with SET_STATS
+   defined, as in make CFLAGS="-g -Wall -DSET_STATS". */
+
+# define SET_HISTOGRAM	16
+
+typedef struct stats {
+    int count;			/* number of elements */
+    int length;			/* number of slots */
+    int deleted;		/* number of tombstones */
+    double load;		/* elements per slot */
+    double hitProbes;		/* average probes to find an element */
+    double missProbes;		/* average probes to miss */
+    int maxHit;			/* most probes to find an element */
+    int maxMiss;		/* most probes to miss */
+    int histogram[SET_HISTOGRAM];	/* elements by probes to find */
+    long compares;		/* strcmp calls, or -1 if not counted */
+} STATS;
+
 SET *createSet(int maxElts);
 
+SET *createSetWith(int maxElts, int mode);
+
 void destroySet(SET *sp);
 
 int numElements(SET *sp);
@@ -27,4 +63,22 @@ char *findElement(SET *sp, char *elt);
 
 char **getElements(SET *sp);
 
+void beginElements(SET *sp, CURSOR *cp);
+
+char *nextElement(SET *sp, CURSOR *cp);
+
+void forEachElement(SET *sp, void (*visit)(), void *arg);
+
+SET *setUnion(SET *sp1, SET *sp2);
+
+SET *setIntersect(SET *sp1, SET *sp2);
+
+SET *setDifference(SET *sp1, SET *sp2);
+
+void getSetStats(SET *sp, STATS *stats);
+
+int saveSet(SET *sp, char *path);
+
+SET *loadSet(char *path);
+
 # endif /* SET_H */
@@ -1,60 +1,392 @@
 #include <assert.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "set.h"
 #include <stdbool.h>
+#include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #define EMPTY 0
-#define FILLED 1
-#define DELETED 2
+#define DELETED 1
+#define FILLED 0x80
+#define GROUP 16
+
+#define MAX_DELETED(n) ((n)/8)
+#define MIN_LENGTH(n) ((n)+(n)/7+1)
+
+#define BATCH_SIZE 64
+#define PASS_SLOTS 65536
+#define MAX_THREADS 16
+
+#define HASH_SEED 0x9e3779b9
+
+#define CHUNK_SIZE 65536
+
+#define MAGIC "STRSET1"
+
+#define DOUBLE_SEED 0x165667b1
+
+#define BLOOM_WORDS 8
+#define BLOOM_SEED 0x27d4eb2f
+#define MAX_STALE(n) (n)
+
+#define SLOT_SIZE 16
+#define SPILLED 0xFF
+#define IS_SPILLED(s) ((unsigned char)(s)->bytes[SLOT_SIZE-1]==SPILLED)
+
+#ifdef SET_STATS
+#define COMPARE(sp, s, t) ((sp)->compares++, strcmp((s), (t)))
+#else
+#define COMPARE(sp, s, t) strcmp((s), (t))
+#endif
+
+struct chunk
+{
+	struct chunk *next;
+	int size;
+	int used;
+	char data[];
+};
+
+struct slot
+{
+	char bytes[SLOT_SIZE];
+};
 
 struct set
 {
 	char **data;
-	char *flags;
+	struct slot *slots;
+	unsigned *hashes;
+	unsigned char *ctrl;
+	int length;
+	int count;
+	int deleted;
+	int mode;
+	bool borrow;
+	bool inlined;
+	bool frozen;
+	struct chunk *chunks;
+	uint32_t *offsets;
+	char *blob;
+	void *map;
+	size_t mapSize;
+	uint32_t *filter;
+	int blocks;
+	int stale;
+#ifdef SET_STATS
+	long compares;
+#endif
+};
+
+struct pass
+{
+	SET *walked;
+	SET *probed;
+	int start;
+	int end;
+	bool keep;
+	char **elts;
+	unsigned *hashes;
+	int count;
+	int size;
+};
+
+struct header
+{
+	char magic[8];
+	unsigned group;
+	unsigned seed;
 	int length;
 	int count;
+	int deleted;
+	int mode;
+	uint64_t blobSize;
 };
 
-static int search(SET *sp, char *elt, bool *found);
+static const uint32_t salts[BLOOM_WORDS]={0x47b6137b, 0x44974d91, 0x8824ad5b, 0xa2b7289d, 0x705495c7, 0x2df1424b, 0x9efc4947, 0x5c6bfb31};
+
+static char *element(SET *sp, int idx);
+static void insert(SET *sp, char *elt, unsigned hash);
+static char *lookup(SET *sp, char *elt, unsigned hash);
+static SET *createLike(SET *sp, int maxElts);
+static int walk(SET *walked, SET *probed, bool keep, char **elts, unsigned *hashes);
+static void *walkRange(void *arg);
+static void keepString(struct pass *pp, char *elt, unsigned hash);
+static void thaw(SET *sp);
+static bool checkSlots(SET *sp, uint64_t blobSize);
+static int search(SET *sp, char *elt, unsigned hash, bool *found);
+static int rhSearch(SET *sp, char *elt, unsigned hash, bool *found, int *dist);
+static void rhInsert(SET *sp, int idx, struct slot *s, unsigned hash);
+static int distance(SET *sp, int idx);
+static void rhDelete(SET *sp, int idx);
+static void setCtrl(SET *sp, int idx, unsigned char c);
+static bool canEmpty(SET *sp, int idx);
+static void compact(SET *sp);
+static char *intern(SET *sp, char *elt);
+static void makeSlot(SET *sp, char *elt, struct slot *s);
+static char *slotString(struct slot *s);
+static void readSlot(SET *sp, int idx, struct slot *s);
+static void writeSlot(SET *sp, int idx, struct slot *s);
+static void initFilter(SET *sp);
+static uint32_t *filterBlock(SET *sp, unsigned hash);
+static void addFilter(SET *sp, unsigned hash);
+static bool maybeContains(SET *sp, unsigned hash);
+static void rebuildFilter(SET *sp);
+static int missGroups(SET *sp, unsigned hash);
+static int hitGroups(SET *sp, int idx);
+static unsigned firstStep(SET *sp, unsigned hash);
+static int rhMissSlots(SET *sp, unsigned pos);
 static unsigned strhash(char *s);
+static unsigned mix(unsigned hash);
+static uint64_t rotl(uint64_t x, int r);
+static unsigned matchTag(unsigned char *group, unsigned char tag);
+static unsigned matchEmpty(unsigned char *group);
+static unsigned matchFree(unsigned char *group);
 
 
-// Creates and allocates memory to the set that holds the pointer to the array of pointers that point to the strings, the string of flags, the current number of elements in the array, and the max number of elements in the array. It also allocates memory for the flag array. In addition, it also sets all the flags in the string to EMPTY
+// Creates a set that uses plain linear probing
 // O(n)
 SET *createSet(int maxElts)
 {
-	int i;
+	return createSetWith(maxElts, SET_LINEAR);
+}
+
+// Creates and allocates memory to the set that holds the pointer to the array of pointers that point to the strings, the array of their full mixed hash values, the array of control bytes, the current number of elements in the array, and the length of the array, which is the smallest power of two that holds maxElts. Each slot has a control byte that is either EMPTY, DELETED, or FILLED with the low 7 bits of the hash value of its string. The control array is followed by a copy of its first GROUP-1 bytes, so that a group starting near the end of the array can be loaded without wrapping around. If SET_BORROW is or'ed into the mode, the set keeps the strings it is given rather than copies of them, which the caller must then keep unchanged until the set is destroyed. If SET_BLOOM is or'ed into the mode, the set also keeps a Bloom filter of the hash values of its strings, which lets findElement and removeElement turn most strings that are not in the set away after reading a single block of the filter, without probing the array. Besides SET_LINEAR and SET_ROBIN_HOOD, the mode may be SET_QUADRATIC or SET_DOUBLE, which probe the groups of the array in another sequence. If SET_INLINE is or'ed into the mode, the array of pointers is replaced by an array of slots of SLOT_SIZE bytes, and a string shorter than a slot is kept in the slot itself, so a search for it never leaves the arrays of the set; only longer strings are copied into the chunks, or borrowed, with a pointer to them in their slot. The strings that such a set returns point into its slots, and so are only good until the set is next changed
+// O(n)
+SET *createSetWith(int maxElts, int mode)
+{
+	int length=GROUP;
 	SET *sp = malloc(sizeof(SET));
-	assert(sp!=NULL);
-	sp->data=malloc(sizeof(char*)*maxElts);
-	assert(sp->data!=NULL);
-	sp->flags=malloc(sizeof(char)*maxElts);
-	assert(sp->flags!=NULL);
-	sp->length=maxElts;
+	bool borrow=(mode&SET_BORROW)!=0;
+	bool bloom=(mode&SET_BLOOM)!=0;
+	bool inlined=(mode&SET_INLINE)!=0;
+	mode&=~(SET_BORROW|SET_BLOOM|SET_INLINE);
+	assert(sp!=NULL && (mode==SET_LINEAR || mode==SET_ROBIN_HOOD || mode==SET_QUADRATIC || mode==SET_DOUBLE));
+	while(length<maxElts)
+		length*=2;
+	sp->data=NULL;
+	sp->slots=NULL;
+	if(inlined==true)
+	{
+		sp->slots=malloc(sizeof(struct slot)*length);
+		assert(sp->slots!=NULL);
+	}
+	else
+	{
+		sp->data=malloc(sizeof(char*)*length);
+		assert(sp->data!=NULL);
+	}
+	sp->hashes=malloc(sizeof(unsigned)*length);
+	assert(sp->hashes!=NULL);
+	sp->ctrl=calloc(length+GROUP-1, sizeof(unsigned char));
+	assert(sp->ctrl!=NULL);
+	sp->length=length;
 	sp->count=0;
-	for(i=0;i<maxElts;i++)
-		sp->flags[i]=EMPTY;
+	sp->deleted=0;
+	sp->mode=mode;
+	sp->borrow=borrow;
+	sp->inlined=inlined;
+	sp->frozen=false;
+	sp->chunks=NULL;
+	sp->offsets=NULL;
+	sp->blob=NULL;
+	sp->map=NULL;
+	sp->mapSize=0;
+	sp->filter=NULL;
+	if(bloom==true)
+		initFilter(sp);
+#ifdef SET_STATS
+	sp->compares=0;
+#endif
 	return sp;
 }
 
-// Frees up the memory allocated to the set in a backwards fashion, starting from each string and ending at the pointer to the set
+// Frees up the memory allocated to the set in a backwards fashion, starting from the chunks that hold the strings and ending at the pointer to the set. A set loaded from a snapshot also unmaps the file, and its arrays are only freed if a change to the set has copied them out of the mapping
 // O(n)
-void destroySet(SET *sp) 
+void destroySet(SET *sp)
 {
 	assert(sp!=NULL);
-	int i;
-	for(i=0;i<sp->length;i++) 
+	struct chunk *cp;
+	while(sp->chunks!=NULL)
 	{
-		if(sp->flags[i]==FILLED)
+		cp=sp->chunks;
+		sp->chunks=cp->next;
+		free(cp);
+	}
+	if(sp->frozen==false)
+	{
+		free(sp->data);
+		free(sp->slots);
+		free(sp->hashes);
+		free(sp->ctrl);
+	}
+	if(sp->map!=NULL)
+		munmap(sp->map, sp->mapSize);
+	free(sp->filter);
+	free(sp);
+	return;
+}
+
+// Writes the set to the file with the given path as a snapshot that loadSet can map back into memory, and returns 1 on success or 0 if the file cannot be written. The file holds a header, the stored hash values, an offset for each slot in place of its string pointer, the control bytes, and then all of the strings packed one after another, so nothing in it depends on the address at which it is loaded. The slots are written as they are, DELETED slots included, so a loaded set probes exactly like this one. A set with SET_INLINE writes its slots in place of the offsets, with the 64-bit offset of each spilled string in place of its pointer, and only the spilled strings are packed after the control bytes. The file is in the byte order of the machine that wrote it
+// O(n)
+int saveSet(SET *sp, char *path)
+{
+	assert(sp!=NULL && path!=NULL);
+	int i, length;
+	uint64_t size=0;
+	uint32_t *offsets=NULL;
+	struct slot *slots=NULL;
+	unsigned *hashes;
+	struct header h;
+	FILE *fp;
+	bool ok;
+	if(sp->inlined==true)
+		slots=calloc(sp->length, sizeof(struct slot));
+	else
+		offsets=calloc(sp->length, sizeof(uint32_t));
+	assert(slots!=NULL || offsets!=NULL);
+	hashes=calloc(sp->length, sizeof(unsigned));
+	assert(hashes!=NULL);
+	for(i=0;i<sp->length;i++)
+	{
+		if(sp->ctrl[i]&FILLED)
 		{
-			free(sp->data[i]); 
+			hashes[i]=sp->hashes[i];
+			if(sp->inlined==true && IS_SPILLED(&sp->slots[i])==false)
+			{
+				slots[i]=sp->slots[i];
+				continue;
+			}
+			if(sp->inlined==true)
+			{
+				memcpy(slots[i].bytes, &size, sizeof(size));
+				slots[i].bytes[SLOT_SIZE-1]=(char)SPILLED;
+			}
+			else
+			{
+				assert(size<=UINT32_MAX);
+				offsets[i]=size;
+			}
+			size+=strlen(element(sp, i))+1;
 		}
 	}
-	free(sp->data);
-	free(sp->flags);
-	free(sp);
-	return; 
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, MAGIC, sizeof(h.magic));
+	h.group=GROUP;
+	h.seed=HASH_SEED;
+	h.length=sp->length;
+	h.count=sp->count;
+	h.deleted=sp->deleted;
+	h.mode=sp->mode|(sp->inlined==true ? SET_INLINE : 0);
+	h.blobSize=size;
+	if((fp=fopen(path, "wb"))==NULL)
+	{
+		free(offsets);
+		free(slots);
+		free(hashes);
+		return 0;
+	}
+	ok=fwrite(&h, sizeof(h), 1, fp)==1;
+	ok=ok && fwrite(hashes, sizeof(unsigned), sp->length, fp)==(size_t)sp->length;
+	if(sp->inlined==true)
+		ok=ok && fwrite(slots, sizeof(struct slot), sp->length, fp)==(size_t)sp->length;
+	else
+		ok=ok && fwrite(offsets, sizeof(uint32_t), sp->length, fp)==(size_t)sp->length;
+	ok=ok && fwrite(sp->ctrl, 1, sp->length+GROUP-1, fp)==(size_t)(sp->length+GROUP-1);
+	for(i=0;ok && i<sp->length;i++)
+	{
+		if((sp->ctrl[i]&FILLED) && (sp->inlined==false || IS_SPILLED(&slots[i])))
+		{
+			length=strlen(element(sp, i))+1;
+			ok=fwrite(element(sp, i), 1, length, fp)==(size_t)length;
+		}
+	}
+	ok=fclose(fp)==0 && ok;
+	free(offsets);
+	free(slots);
+	free(hashes);
+	return ok ? 1 : 0;
+}
+
+// Maps the snapshot written by saveSet to the file with the given path and returns it as a set, or returns NULL if the file cannot be opened or is not a snapshot written by this version of the table. The hash values, offsets, and control bytes are used in place in the read-only mapping and the strings are read straight out of it, so nothing is copied and the set is ready for searches as soon as the header and slots have been checked. The slots are read once by checkSlots, so that a corrupt file whose sizes still match is turned away rather than read out of bounds. The first change to the set copies the arrays out of the mapping and turns the offsets back into pointers; the strings stay in the mapping until the set is destroyed. A loaded set has no Bloom filter
+// O(n)
+SET *loadSet(char *path)
+{
+	assert(path!=NULL);
+	int fd, mode;
+	bool inlined;
+	struct stat st;
+	struct header *hp;
+	char *base;
+	uint64_t size;
+	SET *sp;
+	if((fd=open(path, O_RDONLY))<0)
+		return NULL;
+	if(fstat(fd, &st)<0 || (size_t)st.st_size<sizeof(struct header))
+	{
+		close(fd);
+		return NULL;
+	}
+	base=mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(base==MAP_FAILED)
+		return NULL;
+	hp=(struct header *)base;
+	inlined=(hp->mode&SET_INLINE)!=0;
+	mode=hp->mode&~SET_INLINE;
+	size=sizeof(struct header)+(uint64_t)hp->length*(sizeof(unsigned)+(inlined==true ? sizeof(struct slot) : sizeof(uint32_t)))+hp->length+GROUP-1+hp->blobSize;
+	if(memcmp(hp->magic, MAGIC, sizeof(hp->magic))!=0 || hp->group!=GROUP || hp->seed!=HASH_SEED || hp->length<GROUP || (hp->length&(hp->length-1))!=0 || hp->count<0 || hp->count>hp->length || (mode!=SET_LINEAR && mode!=SET_ROBIN_HOOD && mode!=SET_QUADRATIC && mode!=SET_DOUBLE) || size!=(uint64_t)st.st_size || (hp->blobSize>0 && base[st.st_size-1]!='\0'))
+	{
+		munmap(base, st.st_size);
+		return NULL;
+	}
+	sp=malloc(sizeof(SET));
+	assert(sp!=NULL);
+	sp->length=hp->length;
+	sp->count=hp->count;
+	sp->deleted=hp->deleted;
+	sp->mode=mode;
+	sp->borrow=false;
+	sp->inlined=inlined;
+	sp->frozen=true;
+	sp->chunks=NULL;
+	sp->data=NULL;
+	sp->slots=NULL;
+	sp->offsets=NULL;
+	sp->hashes=(unsigned *)(base+sizeof(struct header));
+	if(inlined==true)
+	{
+		sp->slots=(struct slot *)(sp->hashes+sp->length);
+		sp->ctrl=(unsigned char *)(sp->slots+sp->length);
+	}
+	else
+	{
+		sp->offsets=(uint32_t *)(sp->hashes+sp->length);
+		sp->ctrl=(unsigned char *)(sp->offsets+sp->length);
+	}
+	sp->blob=(char *)sp->ctrl+sp->length+GROUP-1;
+	sp->map=base;
+	sp->mapSize=st.st_size;
+	sp->filter=NULL;
+#ifdef SET_STATS
+	sp->compares=0;
+#endif
+	if(checkSlots(sp, hp->blobSize)==false)
+	{
+		munmap(base, st.st_size);
+		free(sp);
+		return NULL;
+	}
+	return sp;
 }
 
 // Returns the number of elements in the array pointed to by char **data
@@ -65,54 +397,66 @@ int numElements(SET *sp)
 	return sp->count;
 }
 
-// Adds the element to the array pointed to by char **data assuming that the element is not already in the array and that the array is not full, while also updating the count of elements in the array; First, it allocates memory and inserts the element into the array. Next, it changes the corresponding index in the flag string to FILLED. Finally, it updates the count
-// O(n) 
+// Adds the element to the array pointed to by char **data assuming that the element is not already in the array and that the array is not full, while also updating the count of elements in the array; First, it copies the element into the string chunks and inserts the copy into the array. Next, it sets the corresponding control byte to the tag of the element. Finally, it updates the count
+// O(1) expected
 void addElement(SET *sp, char *elt)
 {
-	assert(sp!=NULL && elt!=NULL && sp->count < sp->length);
-	int i, idx;
-	bool found = false;
-	idx=search(sp, elt, &found);
-	if(found==false)
-	{
-		sp->data[idx]=strdup(elt);
-		assert(sp->data[idx]!=NULL);
-		sp->flags[idx]=FILLED;
-		sp->count++;
-	}	
+	assert(sp!=NULL && elt!=NULL);
+	insert(sp, elt, mix(strhash(elt)));
 }
 
-// Removes the element from the array pointed to by char **data assuming that the element is in said array, while also updating the count of elements in the array; First, it changes the corresponding index in the flag string to DELETED. Then, it frees the memory for the deleted element. Finally, it updates the count 
-// O(n) 
+// Removes the element from the array pointed to by char **data assuming that the element is in said array, while also updating the count of elements in the array; First, it sets the corresponding control byte back to EMPTY if no search can have probed past it, or to DELETED otherwise. The copy of the string stays in its chunk until the set is destroyed. Finally, it updates the count and compacts the array once the DELETED slots pass a threshold, so that searches under heavy churn do not get longer over time. In Robin Hood mode, the following elements are shifted back instead, so no DELETED slots are ever left behind. The bits of a removed string cannot be cleared from a Bloom filter, since other strings may share them, so the filter is rebuilt instead once more strings have been removed since it was built than are left in the set
+// O(1) expected
 void removeElement(SET *sp, char *elt)
 {
 	assert(sp!=NULL && elt!=NULL);
-	int idx;
+	int idx, dist;
 	bool found = false;
-	idx=search(sp, elt, &found);
+	unsigned hash = mix(strhash(elt));
+	if(sp->filter!=NULL && maybeContains(sp, hash)==false)
+		return;
+	if(sp->frozen==true)
+		thaw(sp);
+	if(sp->mode==SET_ROBIN_HOOD)
+	{
+		idx=rhSearch(sp, elt, hash, &found, &dist);
+		if(found==true)
+		{
+			rhDelete(sp, idx);
+			sp->count--;
+			if(sp->filter!=NULL && ++sp->stale>MAX_STALE(sp->count))
+				rebuildFilter(sp);
+		}
+		return;
+	}
+	idx=search(sp, elt, hash, &found);
 	if(found==true)
 	{
-		assert(sp->data[idx]!=NULL);
-		sp->flags[idx]=DELETED;
-		free(sp->data[idx]);
+		assert(element(sp, idx)!=NULL);
+		if(canEmpty(sp, idx))
+			setCtrl(sp, idx, EMPTY);
+		else
+		{
+			setCtrl(sp, idx, DELETED);
+			sp->deleted++;
+		}
 		sp->count--;
+		if(sp->deleted>MAX_DELETED(sp->length))
+			compact(sp);
+		if(sp->filter!=NULL && ++sp->stale>MAX_STALE(sp->count))
+			rebuildFilter(sp);
 	}
 }
 
 // Public search function that finds the element pointed to by char *elt and returns the string of the element if found. Else, it returns NULL to indicate that the element was not found
-// O(n)
+// O(1) expected
 char *findElement(SET *sp, char *elt)
 {
 	assert(sp!=NULL && elt!=NULL);
-	bool found = false;
-	search(sp, elt, &found);
-	if(found==false)
-		return NULL;
-	else
-		return elt;
+	return lookup(sp, elt, mix(strhash(elt)));
 }
 
-// Allocates memory to a new array that holds the data from sp->data to be returned to the interface. It copies the data from sp->data to the new array assuming that there is actually information present, which is indicated by the flag array. After which, the new array is returned to the interface
+// Allocates memory to a new array that holds the data from sp->data to be returned to the interface. It copies the data from sp->data to the new array assuming that there is actually information present, which is indicated by the control array. After which, the new array is returned to the interface
 // O(n)
 char **getElements(SET *sp)
 {
@@ -122,63 +466,887 @@ char **getElements(SET *sp)
 	char **temp=malloc(sizeof(char*)*sp->count);
 	for(i=0; i<sp->length; i++)
 	{
-		if(sp->flags[i]==FILLED)
+		if(sp->ctrl[i]&FILLED)
 		{
-			temp[j]=sp->data[i];
+			temp[j]=element(sp, i);
 			j++;
 		}
 	}
 	return temp;
 }
 
-// Private search function that finds the element pointed to by char *elt. The home hashing address is determined at the beginning of the function. Throughout the execution of the 'for' loop, the index is iterated until either the string array indicates a slot is EMPTY or the element elt is found. Furthermore, in the loop, if the string indicates a DELETED spot, that deleted index is noted in case the element ends up not being in the array. That way, that deleted index can be returned in that situation.
+// Starts a traversal of the set with the cursor pointed to by cp, which the caller allocates; Together with nextElement, it visits the FILLED slots in place, so nothing is allocated or copied
+// O(1)
+void beginElements(SET *sp, CURSOR *cp)
+{
+	assert(sp!=NULL && cp!=NULL);
+	cp->index=0;
+}
+
+// Returns the element in the next FILLED slot of the traversal with the cursor pointed to by cp, or NULL once the whole array has been visited. The elements are visited in the same order as getElements, and the set must not be changed during the traversal
+// O(1) amortized
+char *nextElement(SET *sp, CURSOR *cp)
+{
+	assert(sp!=NULL && cp!=NULL);
+	while(cp->index<sp->length)
+	{
+		if(sp->ctrl[cp->index]&FILLED)
+			return element(sp, cp->index++);
+		cp->index++;
+	}
+	return NULL;
+}
+
+// Calls (*visit)(elt, arg) on each element of the set in the order of nextElement, so that the caller can stream the elements without an array of them
 // O(n)
-static int search(SET *sp, char *elt, bool *found)
+void forEachElement(SET *sp, void (*visit)(), void *arg)
 {
-	assert(sp!=NULL && elt!=NULL);
-	int i, idx, delidx;
-	int delFlag=0;
-	unsigned hash = strhash(elt);
-	*found = false;
+	assert(sp!=NULL && visit!=NULL);
+	int i;
 	for(i=0;i<sp->length;i++)
 	{
-		idx=(hash+i)%(sp->length);
-		if(sp->flags[idx]==EMPTY)
+		if(sp->ctrl[i]&FILLED)
+			(*visit)(element(sp, i), arg);
+	}
+}
+
+// Returns a new set that holds the strings that are in either set, with the mode of the first set. The strings of the first set are added with their stored hash values, and walk picks out the strings of the second set that the first does not hold, which are added after them, so no string is hashed again. If the first set borrows its strings, so does the new set, which must then be destroyed before either set
+// O(n+m) expected
+SET *setUnion(SET *sp1, SET *sp2)
+{
+	assert(sp1!=NULL && sp2!=NULL);
+	int i, n;
+	char **elts=malloc(sizeof(char*)*(sp2->count+1));
+	unsigned *hashes=malloc(sizeof(unsigned)*(sp2->count+1));
+	SET *sp;
+	assert(elts!=NULL && hashes!=NULL);
+	n=walk(sp2, sp1, false, elts, hashes);
+	sp=createLike(sp1, sp1->count+n);
+	for(i=0;i<sp1->length;i++)
+		if(sp1->ctrl[i]&FILLED)
+			insert(sp, element(sp1, i), sp1->hashes[i]);
+	for(i=0;i<n;i++)
+		insert(sp, elts[i], hashes[i]);
+	free(elts);
+	free(hashes);
+	return sp;
+}
+
+// Returns a new set that holds the strings that are in both sets, with the mode of the first set. The smaller set is walked by walk and each of its strings is looked up in the larger one, so the work depends only on the size of the smaller set
+// O(min(n, m)) expected
+SET *setIntersect(SET *sp1, SET *sp2)
+{
+	assert(sp1!=NULL && sp2!=NULL);
+	int i, n;
+	SET *small=sp1->count<=sp2->count ? sp1 : sp2;
+	SET *sp;
+	char **elts=malloc(sizeof(char*)*(small->count+1));
+	unsigned *hashes=malloc(sizeof(unsigned)*(small->count+1));
+	assert(elts!=NULL && hashes!=NULL);
+	n=walk(small, small==sp1 ? sp2 : sp1, true, elts, hashes);
+	sp=createLike(sp1, n);
+	for(i=0;i<n;i++)
+		insert(sp, elts[i], hashes[i]);
+	free(elts);
+	free(hashes);
+	return sp;
+}
+
+// Returns a new set that holds the strings of the first set that are not in the second, with the mode of the first set. The first set is walked by walk and each of its strings is looked up in the second, so neither set is changed, unlike removing the strings of the second set from the first one at a time
+// O(n) expected
+SET *setDifference(SET *sp1, SET *sp2)
+{
+	assert(sp1!=NULL && sp2!=NULL);
+	int i, n;
+	SET *sp;
+	char **elts=malloc(sizeof(char*)*(sp1->count+1));
+	unsigned *hashes=malloc(sizeof(unsigned)*(sp1->count+1));
+	assert(elts!=NULL && hashes!=NULL);
+	n=walk(sp1, sp2, false, elts, hashes);
+	sp=createLike(sp1, n);
+	for(i=0;i<n;i++)
+		insert(sp, elts[i], hashes[i]);
+	free(elts);
+	free(hashes);
+	return sp;
+}
+
+// Fills in the statistics pointed to by stats, which are worked out from the control bytes and stored hash values alone, so strcmp is not called. In Robin Hood mode, a probe is one slot, and otherwise it is one group. The probes to miss are averaged over every home slot, where a miss from each home slot is taken to follow the probe sequence of a hash value with that home slot and no other bits set
+// O(n)
+void getSetStats(SET *sp, STATS *stats)
+{
+	assert(sp!=NULL && stats!=NULL);
+	int i, probes;
+	double total=0;
+	memset(stats, 0, sizeof(STATS));
+	stats->count=sp->count;
+	stats->length=sp->length;
+	stats->deleted=sp->deleted;
+	stats->load=(double)sp->count/sp->length;
+	for(i=0;i<sp->length;i++)
+	{
+		probes=sp->mode==SET_ROBIN_HOOD ? rhMissSlots(sp, i) : missGroups(sp, i<<7);
+		total+=probes;
+		if(probes>stats->maxMiss)
+			stats->maxMiss=probes;
+		if(sp->ctrl[i]&FILLED)
+		{
+			probes=sp->mode==SET_ROBIN_HOOD ? distance(sp, i)+1 : hitGroups(sp, i);
+			stats->hitProbes+=probes;
+			if(probes>stats->maxHit)
+				stats->maxHit=probes;
+			stats->histogram[probes<SET_HISTOGRAM ? probes : SET_HISTOGRAM-1]++;
+		}
+	}
+	stats->missProbes=total/sp->length;
+	if(sp->count>0)
+		stats->hitProbes/=sp->count;
+#ifdef SET_STATS
+	stats->compares=sp->compares;
+#else
+	stats->compares=-1;
+#endif
+}
+
+// Returns the string in slot idx, which is read through its offset into the strings of the mapping if the set was loaded from a snapshot and has not been changed since. In a set with SET_INLINE, a short string is returned in place in its slot, and a spilled one is read through its pointer, or through its offset in a snapshot
+// O(1)
+static char *element(SET *sp, int idx)
+{
+	uint64_t offset;
+	if(sp->inlined==false)
+		return sp->frozen==false ? sp->data[idx] : sp->blob+sp->offsets[idx];
+	if(sp->frozen==true && IS_SPILLED(&sp->slots[idx]))
+	{
+		memcpy(&offset, sp->slots[idx].bytes, sizeof(offset));
+		return sp->blob+offset;
+	}
+	return slotString(&sp->slots[idx]);
+}
+
+// Adds the element with the given mixed hash value as addElement does, so that a string whose hash value is already stored is not hashed again
+// O(1) expected
+static void insert(SET *sp, char *elt, unsigned hash)
+{
+	assert(sp->count < sp->length);
+	int idx, dist;
+	bool found = false;
+	struct slot s;
+	if(sp->frozen==true)
+		thaw(sp);
+	if(sp->mode==SET_ROBIN_HOOD)
+	{
+		idx=rhSearch(sp, elt, hash, &found, &dist);
+		if(found==false)
 		{
-			if(delFlag==1)
-				return delidx;
+			makeSlot(sp, elt, &s);
+			rhInsert(sp, idx, &s, hash);
+			sp->count++;
+			if(sp->filter!=NULL)
+				addFilter(sp, hash);
+		}
+		return;
+	}
+	idx=search(sp, elt, hash, &found);
+	if(found==false)
+	{
+		if(sp->ctrl[idx]==DELETED)
+			sp->deleted--;
+		makeSlot(sp, elt, &s);
+		writeSlot(sp, idx, &s);
+		sp->hashes[idx]=hash;
+		setCtrl(sp, idx, FILLED|(hash&0x7F));
+		sp->count++;
+		if(sp->filter!=NULL)
+			addFilter(sp, hash);
+	}
+}
+
+// Private search function that finds the element with the given mixed hash value as findElement does, returning its string or NULL
+// O(1) expected
+static char *lookup(SET *sp, char *elt, unsigned hash)
+{
+	int idx, dist;
+	bool found = false;
+	if(sp->filter!=NULL && maybeContains(sp, hash)==false)
+		return NULL;
+	if(sp->mode==SET_ROBIN_HOOD)
+		idx=rhSearch(sp, elt, hash, &found, &dist);
+	else
+		idx=search(sp, elt, hash, &found);
+	if(found==false)
+		return NULL;
+	return element(sp, idx);
+}
+
+// Creates an empty set with the mode of the set pointed to by sp, including whether it borrows its strings, keeps a Bloom filter, and keeps short strings in its slots, and with room for maxElts elements at a load of no more than 7/8
+// O(n)
+static SET *createLike(SET *sp, int maxElts)
+{
+	int mode=sp->mode;
+	if(sp->borrow==true)
+		mode|=SET_BORROW;
+	if(sp->filter!=NULL)
+		mode|=SET_BLOOM;
+	if(sp->inlined==true)
+		mode|=SET_INLINE;
+	return createSetWith(MIN_LENGTH(maxElts), mode);
+}
+
+// Walks the FILLED slots of the set walked and looks up each of its strings in the set probed, storing the strings that are found if keep is true, or that are not found otherwise, in the array elts, along with their stored hash values in the array hashes, and returns how many there are. Both arrays must have room for every string of the set walked. Neither set is changed, since lookups never thaw a set, so when the set walked has at least PASS_SLOTS slots for each, its slots are split into ranges that are walked by threads of their own, one for each processor up to MAX_THREADS, and the strings kept by each range are then copied into the arrays in the order of the ranges. The compare calls are only counted with a single thread
+// O(n) expected
+static int walk(SET *walked, SET *probed, bool keep, char **elts, unsigned *hashes)
+{
+	int i, t=1, n=0;
+	pthread_t tids[MAX_THREADS];
+	struct pass passes[MAX_THREADS];
+#ifndef SET_STATS
+	t=sysconf(_SC_NPROCESSORS_ONLN);
+	if(t>MAX_THREADS)
+		t=MAX_THREADS;
+	if(t>walked->length/PASS_SLOTS)
+		t=walked->length/PASS_SLOTS;
+	if(t<1)
+		t=1;
+#endif
+	for(i=0;i<t;i++)
+	{
+		passes[i].walked=walked;
+		passes[i].probed=probed;
+		passes[i].start=(long)walked->length*i/t;
+		passes[i].end=(long)walked->length*(i+1)/t;
+		passes[i].keep=keep;
+		passes[i].elts=NULL;
+		passes[i].hashes=NULL;
+		passes[i].count=0;
+		passes[i].size=0;
+	}
+	if(t==1)
+	{
+		passes[0].elts=elts;
+		passes[0].hashes=hashes;
+		passes[0].size=walked->count+1;
+		walkRange(&passes[0]);
+		return passes[0].count;
+	}
+	for(i=0;i<t;i++)
+		pthread_create(&tids[i], NULL, walkRange, &passes[i]);
+	for(i=0;i<t;i++)
+	{
+		pthread_join(tids[i], NULL);
+		if(passes[i].count>0)
+		{
+			memcpy(elts+n, passes[i].elts, sizeof(char*)*passes[i].count);
+			memcpy(hashes+n, passes[i].hashes, sizeof(unsigned)*passes[i].count);
+			n+=passes[i].count;
+		}
+		free(passes[i].elts);
+		free(passes[i].hashes);
+	}
+	return n;
+}
+
+// Walks one range of slots for walk. The strings are gathered BATCH_SIZE at a time, and the home group of each in the set probed is prefetched as it is gathered, so that the cache misses of the whole batch overlap before any of it is looked up. The stored hash values are reused, so no string is hashed again
+// O(n) expected
+static void *walkRange(void *arg)
+{
+	struct pass *pp=arg;
+	SET *walked=pp->walked, *probed=pp->probed;
+	char *elts[BATCH_SIZE];
+	unsigned hashes[BATCH_SIZE];
+	int i, j, m;
+	unsigned pos, mask=probed->length-1;
+	for(i=pp->start;i<pp->end;)
+	{
+		for(m=0;m<BATCH_SIZE && i<pp->end;i++)
+		{
+			if(walked->ctrl[i]&FILLED)
+			{
+				elts[m]=element(walked, i);
+				hashes[m]=walked->hashes[i];
+				pos=(hashes[m]>>7)&mask;
+				__builtin_prefetch(probed->ctrl+pos);
+				__builtin_prefetch(probed->hashes+pos);
+				if(probed->filter!=NULL)
+					__builtin_prefetch(filterBlock(probed, hashes[m]));
+				m++;
+			}
+		}
+		for(j=0;j<m;j++)
+			if((lookup(probed, elts[j], hashes[j])!=NULL)==pp->keep)
+				keepString(pp, elts[j], hashes[j]);
+	}
+	return NULL;
+}
+
+// Appends the string and its hash value to the arrays of the range pointed to by pp, which double in size as they fill up. The single range of a walk that is not split writes straight into the arrays of its caller, which have room for every string, so they never grow
+// O(1) amortized
+static void keepString(struct pass *pp, char *elt, unsigned hash)
+{
+	if(pp->count==pp->size)
+	{
+		pp->size=pp->size>0 ? pp->size*2 : BATCH_SIZE;
+		pp->elts=realloc(pp->elts, sizeof(char*)*pp->size);
+		pp->hashes=realloc(pp->hashes, sizeof(unsigned)*pp->size);
+		assert(pp->elts!=NULL && pp->hashes!=NULL);
+	}
+	pp->elts[pp->count]=elt;
+	pp->hashes[pp->count++]=hash;
+}
+
+// Copies the arrays of a set loaded from a snapshot out of the read-only mapping so that the set can be changed, turning the offset of each FILLED slot back into a pointer to its string in the mapping. In a set with SET_INLINE, the slots are copied as they are, and only the offsets of the spilled strings are turned into pointers
+// O(n)
+static void thaw(SET *sp)
+{
+	int i;
+	char *elt;
+	unsigned *hashes=sp->hashes;
+	unsigned char *ctrl=sp->ctrl;
+	struct slot *slots=sp->slots;
+	if(sp->inlined==true)
+	{
+		sp->slots=malloc(sizeof(struct slot)*sp->length);
+		assert(sp->slots!=NULL);
+		memcpy(sp->slots, slots, sizeof(struct slot)*sp->length);
+	}
+	else
+	{
+		sp->data=malloc(sizeof(char*)*sp->length);
+		assert(sp->data!=NULL);
+	}
+	sp->hashes=malloc(sizeof(unsigned)*sp->length);
+	assert(sp->hashes!=NULL);
+	sp->ctrl=malloc(sp->length+GROUP-1);
+	assert(sp->ctrl!=NULL);
+	memcpy(sp->hashes, hashes, sizeof(unsigned)*sp->length);
+	memcpy(sp->ctrl, ctrl, sp->length+GROUP-1);
+	for(i=0;i<sp->length;i++)
+	{
+		if(ctrl[i]&FILLED)
+		{
+			if(sp->inlined==false)
+				sp->data[i]=sp->blob+sp->offsets[i];
+			else if(IS_SPILLED(&slots[i]))
+			{
+				elt=element(sp, i);
+				memcpy(sp->slots[i].bytes, &elt, sizeof(char*));
+			}
+		}
+	}
+	sp->offsets=NULL;
+	sp->frozen=false;
+}
+
+// Returns true if every FILLED slot of a set just mapped by loadSet holds a string that lies within the mapping and the number of FILLED slots is the count in the header. Since saveSet ends the strings with a terminator and loadSet checks that the file does too, an offset below blobSize is enough to keep strcmp within the strings. A string kept in a slot of a set with SET_INLINE must have its terminator within the slot
+// O(n)
+static bool checkSlots(SET *sp, uint64_t blobSize)
+{
+	int i, n=0;
+	uint64_t offset;
+	bool ok;
+	for(i=0;i<sp->length;i++)
+	{
+		if(sp->ctrl[i]&FILLED)
+		{
+			n++;
+			if(sp->inlined==false)
+				ok=sp->offsets[i]<blobSize;
+			else if(IS_SPILLED(&sp->slots[i]))
+			{
+				memcpy(&offset, sp->slots[i].bytes, sizeof(offset));
+				ok=offset<blobSize;
+			}
 			else
-				return idx;
+				ok=memchr(sp->slots[i].bytes, '\0', SLOT_SIZE)!=NULL;
+			if(ok==false)
+				return false;
 		}
-		else if(sp->flags[idx]==FILLED)
+	}
+	return n==sp->count;
+}
+
+// Private search function that finds the element pointed to by char *elt. The home hashing address and the 7-bit tag are both taken from the mixed hash value. The array is probed a group of GROUP slots at a time: the control bytes of the whole group are compared with the tag at once, and strcmp is only called for the slots whose tag and stored hash value both match, so the string pointers of other slots are never followed. The first EMPTY or DELETED slot seen is noted in case the element ends up not being in the array, so that it can be returned as the slot for an insertion. The search stops at the first group that has an EMPTY slot, since the element would have been placed there or earlier. Each group after the first is found by moving a step forward, where the step is given by firstStep and grows by a group after every move in quadratic mode
+// O(1) expected
+static int search(SET *sp, char *elt, unsigned hash, bool *found)
+{
+	assert(sp!=NULL && elt!=NULL);
+	int i, idx, freeidx=-1;
+	unsigned bits, mask=sp->length-1;
+	unsigned pos=(hash>>7)&mask, step=firstStep(sp, hash);
+	unsigned char tag=FILLED|(hash&0x7F), *group;
+	*found = false;
+	for(i=0;i<sp->length;i+=GROUP)
+	{
+		group=sp->ctrl+pos;
+		for(bits=matchTag(group, tag); bits!=0; bits&=bits-1)
 		{
-			if(strcmp(sp->data[idx],elt)==0)
+			idx=(pos+__builtin_ctz(bits))&mask;
+			if(sp->hashes[idx]==hash && COMPARE(sp, element(sp, idx), elt)==0)
 			{
 				*found=true;
 				return idx;
 			}
 		}
-		else
+		bits=matchFree(group);
+		if(freeidx==-1 && bits!=0)
+			freeidx=(pos+__builtin_ctz(bits))&mask;
+		if(matchEmpty(group)!=0)
+			break;
+		pos=(pos+step)&mask;
+		if(sp->mode==SET_QUADRATIC)
+			step+=GROUP;
+	}
+	return freeidx;
+}
+
+// Private search function for Robin Hood mode. Like search, it walks the slots from the home hashing address, but one slot at a time, and it also tracks the probe distance of elt. Since Robin Hood insertion keeps every element at least as close to its home as any element it passed over, the search stops as soon as it reaches a slot whose element is closer to its own home than elt would be there. The probe distance of an element is computed from its stored hash value, and strcmp is only called when the stored hash value matches. The returned index and *dist give the slot and probe distance at which an insertion should start
+// O(1) expected
+static int rhSearch(SET *sp, char *elt, unsigned hash, bool *found, int *dist)
+{
+	assert(sp!=NULL && elt!=NULL);
+	int d, idx;
+	unsigned mask=sp->length-1;
+	idx=(hash>>7)&mask;
+	*found=false;
+	for(d=0;d<sp->length;d++)
+	{
+		if(sp->ctrl[idx]==EMPTY || distance(sp, idx)<d)
+			break;
+		if(sp->hashes[idx]==hash && COMPARE(sp, element(sp, idx), elt)==0)
+		{
+			*found=true;
+			break;
+		}
+		idx=(idx+1)&mask;
+	}
+	*dist=d;
+	return idx;
+}
+
+// Inserts the slot pointed to by s, made by makeSlot, with the given hash value at slot idx; Whenever the slot holds an element that is closer to its home than the one being placed, the two are swapped and the displaced element continues down the array. This keeps the probe distances of all elements close to each other
+// O(1) expected
+static void rhInsert(SET *sp, int idx, struct slot *s, unsigned hash)
+{
+	assert(s!=NULL);
+	struct slot elt=*s, tmp;
+	unsigned h, mask=sp->length-1;
+	int dist=(idx-(hash>>7))&mask;
+	while(sp->ctrl[idx]!=EMPTY)
+	{
+		if(distance(sp, idx)<dist)
+		{
+			readSlot(sp, idx, &tmp);
+			h=sp->hashes[idx];
+			writeSlot(sp, idx, &elt);
+			sp->hashes[idx]=hash;
+			setCtrl(sp, idx, FILLED|(hash&0x7F));
+			elt=tmp;
+			hash=h;
+			dist=distance(sp, idx);
+		}
+		idx=(idx+1)&mask;
+		dist++;
+	}
+	writeSlot(sp, idx, &elt);
+	sp->hashes[idx]=hash;
+	setCtrl(sp, idx, FILLED|(hash&0x7F));
+}
+
+// Deletes the element at slot idx without leaving a DELETED slot behind; The elements following it are shifted back by one slot until an EMPTY slot or an element already in its home slot is reached
+// O(1) expected
+static void rhDelete(SET *sp, int idx)
+{
+	unsigned mask=sp->length-1;
+	int next=(idx+1)&mask;
+	struct slot s;
+	while(sp->ctrl[next]!=EMPTY && distance(sp, next)>0)
+	{
+		readSlot(sp, next, &s);
+		writeSlot(sp, idx, &s);
+		sp->hashes[idx]=sp->hashes[next];
+		setCtrl(sp, idx, sp->ctrl[next]);
+		idx=next;
+		next=(next+1)&mask;
+	}
+	setCtrl(sp, idx, EMPTY);
+}
+
+// Returns the probe distance of the element at slot idx from its home slot, which is computed from its stored hash value
+// O(1)
+static int distance(SET *sp, int idx)
+{
+	return (idx-(sp->hashes[idx]>>7))&(sp->length-1);
+}
+
+// Sets the control byte of slot idx, along with its copy past the end of the control array if it is one of the first GROUP-1 slots
+// O(1)
+static void setCtrl(SET *sp, int idx, unsigned char c)
+{
+	sp->ctrl[idx]=c;
+	if(idx<GROUP-1)
+		sp->ctrl[sp->length+idx]=c;
+}
+
+// Returns true if every group of GROUP slots that contains slot idx also contains an EMPTY slot. Since a search stops at the first group with an EMPTY slot, no search can then have probed past idx, so the slot can be set back to EMPTY instead of DELETED when its element is removed. The EMPTY slots just before and just after idx are found with one group each, and the run of non-EMPTY slots between them must be shorter than a group
+// O(1)
+static bool canEmpty(SET *sp, int idx)
+{
+	unsigned before=matchEmpty(sp->ctrl+((idx-GROUP)&(sp->length-1)));
+	unsigned after=matchEmpty(sp->ctrl+idx);
+	if(before==0 || after==0)
+		return false;
+	return __builtin_clz(before<<(32-GROUP))+__builtin_ctz(after)<GROUP;
+}
+
+// Rebuilds the array in place to clear out its DELETED slots; The elements are moved to fresh arrays of the same length using their stored hash values, so no string is hashed again
+// O(n)
+static void compact(SET *sp)
+{
+	int i, idx;
+	bool found;
+	char **data=sp->data;
+	struct slot *slots=sp->slots;
+	unsigned *hashes=sp->hashes;
+	unsigned char *ctrl=sp->ctrl;
+	if(sp->inlined==true)
+	{
+		sp->slots=malloc(sizeof(struct slot)*sp->length);
+		assert(sp->slots!=NULL);
+	}
+	else
+	{
+		sp->data=malloc(sizeof(char*)*sp->length);
+		assert(sp->data!=NULL);
+	}
+	sp->hashes=malloc(sizeof(unsigned)*sp->length);
+	assert(sp->hashes!=NULL);
+	sp->ctrl=calloc(sp->length+GROUP-1, sizeof(unsigned char));
+	assert(sp->ctrl!=NULL);
+	for(i=0;i<sp->length;i++)
+	{
+		if(ctrl[i]&FILLED)
 		{
-			if(delFlag==0)
+			if(sp->inlined==true)
+			{
+				idx=search(sp, slotString(&slots[i]), hashes[i], &found);
+				sp->slots[idx]=slots[i];
+			}
+			else
 			{
-				delFlag=1;
-				delidx=idx;
+				idx=search(sp, data[i], hashes[i], &found);
+				sp->data[idx]=data[i];
 			}
+			sp->hashes[idx]=hashes[i];
+			setCtrl(sp, idx, ctrl[i]);
 		}
-	}	
-	return idx;
+	}
+	sp->deleted=0;
+	free(data);
+	free(slots);
+	free(hashes);
+	free(ctrl);
+}
+
+// Copies the string elt into the chunk at the head of the list of chunks and returns the copy; A new chunk is allocated when the string does not fit in the space left, so that the strings are packed together without the overhead of a separate allocation each, and the whole list is freed at once by destroySet. A string longer than a chunk gets a chunk of its own, which is linked behind the head so the space left in the head is not wasted. A set that borrows its strings returns elt itself
+// O(n)
+static char *intern(SET *sp, char *elt)
+{
+	int length;
+	struct chunk *cp=sp->chunks;
+	char *copy;
+	if(sp->borrow==true)
+		return elt;
+	length=strlen(elt)+1;
+	if(cp==NULL || cp->size-cp->used<length)
+	{
+		int size=length>CHUNK_SIZE ? length : CHUNK_SIZE;
+		cp=malloc(sizeof(struct chunk)+size);
+		assert(cp!=NULL);
+		cp->size=size;
+		cp->used=0;
+		if(size>CHUNK_SIZE && sp->chunks!=NULL)
+		{
+			cp->next=sp->chunks->next;
+			sp->chunks->next=cp;
+		}
+		else
+		{
+			cp->next=sp->chunks;
+			sp->chunks=cp;
+		}
+	}
+	copy=cp->data+cp->used;
+	memcpy(copy, elt, length);
+	cp->used+=length;
+	return copy;
+}
+
+// Fills in the slot pointed to by s for the string elt. In a set with SET_INLINE, a string shorter than SLOT_SIZE is copied into the slot itself, padded with zeros, and the last byte of the slot is set to SLOT_SIZE-1 less the length of the string, which is zero, and so also its terminator, for a string that fills the slot. A longer string is interned and spilled: the slot holds the pointer to it, with SPILLED as its last byte. Otherwise, the slot just holds the pointer returned by intern
+// O(n)
+static void makeSlot(SET *sp, char *elt, struct slot *s)
+{
+	int length;
+	char *copy;
+	if(sp->inlined==true)
+	{
+		length=strlen(elt);
+		if(length<SLOT_SIZE)
+		{
+			memset(s->bytes, 0, SLOT_SIZE);
+			memcpy(s->bytes, elt, length);
+			s->bytes[SLOT_SIZE-1]=SLOT_SIZE-1-length;
+			return;
+		}
+		s->bytes[SLOT_SIZE-1]=(char)SPILLED;
+	}
+	copy=intern(sp, elt);
+	memcpy(s->bytes, &copy, sizeof(char*));
+}
+
+// Returns the string of a slot of a set with SET_INLINE that is not in a snapshot, which is either in the slot itself or pointed to by it
+// O(1)
+static char *slotString(struct slot *s)
+{
+	char *elt;
+	if(IS_SPILLED(s)==false)
+		return s->bytes;
+	memcpy(&elt, s->bytes, sizeof(char*));
+	return elt;
+}
+
+// Copies slot idx of the array into the slot pointed to by s, or just its pointer into the first bytes of s if the set does not have SET_INLINE, so that elements can be moved between slots in either layout
+// O(1)
+static void readSlot(SET *sp, int idx, struct slot *s)
+{
+	if(sp->inlined==true)
+		*s=sp->slots[idx];
+	else
+		memcpy(s->bytes, &sp->data[idx], sizeof(char*));
+}
+
+// Copies the slot pointed to by s, as read by readSlot or made by makeSlot, into slot idx of the array
+// O(1)
+static void writeSlot(SET *sp, int idx, struct slot *s)
+{
+	if(sp->inlined==true)
+		sp->slots[idx]=*s;
+	else
+		memcpy(&sp->data[idx], s->bytes, sizeof(char*));
+}
+
+// Allocates a Bloom filter with one byte for each slot of the array, all clear. The filter is split into blocks of BLOOM_WORDS 32-bit words, which are aligned so that no block crosses a cache line
+// O(n)
+static void initFilter(SET *sp)
+{
+	free(sp->filter);
+	sp->blocks=sp->length/32>0 ? sp->length/32 : 1;
+	sp->filter=aligned_alloc(sizeof(uint32_t)*BLOOM_WORDS, sizeof(uint32_t)*BLOOM_WORDS*sp->blocks);
+	assert(sp->filter!=NULL);
+	memset(sp->filter, 0, sizeof(uint32_t)*BLOOM_WORDS*sp->blocks);
+	sp->stale=0;
+}
+
+// Returns the block of the Bloom filter for the given mixed hash value, which is picked by the hash value mixed again with a different seed, so that it does not depend on the same bits as the home slot
+// O(1)
+static uint32_t *filterBlock(SET *sp, unsigned hash)
+{
+	return sp->filter+(mix(hash^BLOOM_SEED)&(sp->blocks-1))*BLOOM_WORDS;
+}
+
+// Adds the given mixed hash value to the Bloom filter by setting one bit in each word of its block. The bit in each word is picked by the top five bits of the hash value times an odd constant of its own, as in a split block Bloom filter
+// O(1)
+static void addFilter(SET *sp, unsigned hash)
+{
+	int i;
+	uint32_t *bp=filterBlock(sp, hash);
+	for(i=0;i<BLOOM_WORDS;i++)
+		bp[i]|=1u<<((hash*salts[i])>>27);
+}
+
+// Returns false if the given mixed hash value is definitely not in the Bloom filter, that is, if any of its bits is clear, or true if it may be. Only one block of the filter is read
+// O(1)
+static bool maybeContains(SET *sp, unsigned hash)
+{
+	int i;
+	uint32_t *bp=filterBlock(sp, hash);
+	for(i=0;i<BLOOM_WORDS;i++)
+		if(!(bp[i]&(1u<<((hash*salts[i])>>27))))
+			return false;
+	return true;
+}
+
+// Rebuilds the Bloom filter from the stored hash values of the strings in the array, so the strings removed since the filter was last built no longer set any of its bits
+// O(n)
+static void rebuildFilter(SET *sp)
+{
+	int i;
+	initFilter(sp);
+	for(i=0;i<sp->length;i++)
+		if(sp->ctrl[i]&FILLED)
+			addFilter(sp, sp->hashes[i]);
+}
+
+// Returns the number of groups that a search for a string with the given mixed hash value reads before it reaches a group with an EMPTY slot, which is the number of probes for a miss in every mode but Robin Hood
+// O(1) expected
+static int missGroups(SET *sp, unsigned hash)
+{
+	int n=1;
+	unsigned mask=sp->length-1;
+	unsigned pos=(hash>>7)&mask, step=firstStep(sp, hash);
+	while(n*GROUP<sp->length && matchEmpty(sp->ctrl+pos)==0)
+	{
+		pos=(pos+step)&mask;
+		if(sp->mode==SET_QUADRATIC)
+			step+=GROUP;
+		n++;
+	}
+	return n;
+}
+
+// Returns the number of groups that a search reads to find the string in slot idx, which is the position in its probe sequence of the first group that holds the slot
+// O(1) expected
+static int hitGroups(SET *sp, int idx)
+{
+	int n=1;
+	unsigned mask=sp->length-1;
+	unsigned pos=(sp->hashes[idx]>>7)&mask, step=firstStep(sp, sp->hashes[idx]);
+	while(((idx-pos)&mask)>=GROUP)
+	{
+		pos=(pos+step)&mask;
+		if(sp->mode==SET_QUADRATIC)
+			step+=GROUP;
+		n++;
+	}
+	return n;
+}
+
+// Returns the distance from the first group that a search for a string with the given mixed hash value reads to the second. It is a single group in linear and quadratic mode. In double hashing mode, it is an odd number of groups taken from the hash value mixed again with a different seed, so that strings with the same home slot still follow different sequences; Since the number of groups in the array is a power of two, an odd step reaches every group before coming back to the first, and so do the triangular offsets of quadratic mode
+// O(1)
+static unsigned firstStep(SET *sp, unsigned hash)
+{
+	if(sp->mode==SET_DOUBLE)
+		return (mix(hash^DOUBLE_SEED)|1)*GROUP;
+	return GROUP;
+}
+
+// Returns the number of slots that rhSearch reads for a miss whose home slot is pos, stopping at an EMPTY slot or at an element closer to its home than the missing string would be
+// O(1) expected
+static int rhMissSlots(SET *sp, unsigned pos)
+{
+	int d;
+	for(d=0;d<sp->length;d++)
+	{
+		if(sp->ctrl[pos]==EMPTY || distance(sp, pos)<d)
+			break;
+		pos=(pos+1)&(sp->length-1);
+	}
+	return d<sp->length ? d+1 : d;
 }
 
-// Determines the home hashing address for a string
+// Determines the home hashing address for a string; The bytes of the string are consumed 8 at a time, as in the body of MurmurHash3, and the tail is read as one zero-padded word. The result is avalanched with the 64-bit finalizer of MurmurHash3, so every input bit affects every output bit
 // O(n)
 static unsigned strhash(char *s)
 {
-	unsigned hash = 0;
-	while(*s != '\0')
+	int length=strlen(s);
+	uint64_t h=HASH_SEED^(length*0x9e3779b97f4a7c15ULL);
+	uint64_t w;
+	while(length>=8)
 	{
-		hash = 31*hash + *s ++;
+		memcpy(&w, s, 8);
+		w*=0x87c37b91114253d5ULL;
+		w=rotl(w, 31);
+		w*=0x4cf5ad432745937fULL;
+		h^=w;
+		h=rotl(h, 27)*5+0x52dce729;
+		s+=8;
+		length-=8;
 	}
+	w=0;
+	memcpy(&w, s, length);
+	h^=w*0x87c37b91114253d5ULL;
+	h^=h>>33;
+	h*=0xff51afd7ed558ccdULL;
+	h^=h>>33;
+	h*=0xc4ceb9fe1a85ec53ULL;
+	h^=h>>33;
+	return (unsigned)h;
+}
+
+// Mixes the bits of a hash value, since the low bits pick the tag and the high bits pick the home slot of a power-of-two array; This is the finalizer of MurmurHash3
+// O(1)
+static unsigned mix(unsigned hash)
+{
+	hash^=hash>>16;
+	hash*=0x85ebca6b;
+	hash^=hash>>13;
+	hash*=0xc2b2ae35;
+	hash^=hash>>16;
 	return hash;
 }
 
+// Rotates the bits of a 64-bit word left by r places
+// O(1)
+static uint64_t rotl(uint64_t x, int r)
+{
+	return (x<<r)|(x>>(64-r));
+}
+
+#ifdef __SSE2__
+
+// Returns a bit mask of the slots in the group whose control byte equals the tag, comparing all GROUP bytes at once
+// O(1)
+static unsigned matchTag(unsigned char *group, unsigned char tag)
+{
+	__m128i ctrl=_mm_loadu_si128((__m128i *)group);
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(tag)));
+}
+
+// Returns a bit mask of the EMPTY slots in the group
+// O(1)
+static unsigned matchEmpty(unsigned char *group)
+{
+	__m128i ctrl=_mm_loadu_si128((__m128i *)group);
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_setzero_si128()));
+}
+
+// Returns a bit mask of the EMPTY or DELETED slots in the group, which are exactly the slots whose control byte has its high bit clear
+// O(1)
+static unsigned matchFree(unsigned char *group)
+{
+	__m128i ctrl=_mm_loadu_si128((__m128i *)group);
+	return ~_mm_movemask_epi8(ctrl)&0xFFFF;
+}
+
+#else
+
+// Returns a bit mask of the slots in the group whose control byte equals the tag
+// O(1)
+static unsigned matchTag(unsigned char *group, unsigned char tag)
+{
+	int i;
+	unsigned bits=0;
+	for(i=0;i<GROUP;i++)
+		if(group[i]==tag)
+			bits|=1u<<i;
+	return bits;
+}
+
+// Returns a bit mask of the EMPTY slots in the group
+// O(1)
+static unsigned matchEmpty(unsigned char *group)
+{
+	return matchTag(group, EMPTY);
+}
+
+// Returns a bit mask of the EMPTY or DELETED slots in the group
+// O(1)
+static unsigned matchFree(unsigned char *group)
+{
+	int i;
+	unsigned bits=0;
+	for(i=0;i<GROUP;i++)
+		if(!(group[i]&FILLED))
+			bits|=1u<<i;
+	return bits;
+}
+
+#endif
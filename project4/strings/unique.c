@@ -11,7 +11,16 @@
  *              are inserted into the set and the counts of total words and
  *              total words in the set are printed.  If the second file is
  *              given then all words in the second file are deleted from
- *              the set and the count printed.
+ *              the set and the count printed.  The -r, -q, and -d
+ *              options select Robin Hood probing, quadratic probing, and
+ *              double hashing instead of linear probing, the -b option
+ *              keeps a Bloom filter in front of the set so that most words
+ *              of the second file that are not in the set are rejected
+ *              without probing, the -i option keeps words of fewer than
+ *              sixteen characters in the slots of the set itself, the -s
+ *              option prints the probe lengths and occupancy of the set at
+ *              the end, and the -w option writes the final set to a
+ *              snapshot file that loadSet can map back in.
  */
 
 # include <stdio.h>
@@ -19,6 +28,7 @@
 # include <string.h>
 # include <stdbool.h>
 # include "set.h"
+# include "words.h"
 
 
 /* This is sufficient for the test cases in /scratch/coen12. */
@@ -26,6 +36,72 @@
 # define MAX_SIZE 18000
 
 
+/*
+ * Function:    printElement
+ *
+ * Description: Print an element of the set on a line of its own.
+ */
+
+static void printElement(char *elt, FILE *fp)
+{
+    fprintf(fp, "%s\n", elt);
+}
+
+
+/*
+ * Function:    printStats
+ *
+ * Description: Print the statistics of a set, as given by getSetStats.
+ */
+
+static void printStats(SET *sp)
+{
+    STATS stats;
+    int i;
+
+
+    getSetStats(sp, &stats);
+    printf("%d elements in %d slots, load %.3f\n", stats.count, stats.length,
+	   stats.load);
+    printf("%d tombstones, ratio %.3f\n", stats.deleted,
+	   (double) stats.deleted / stats.length);
+    printf("probes to find: average %.3f, most %d\n", stats.hitProbes,
+	   stats.maxHit);
+    printf("probes to miss: average %.3f, most %d\n", stats.missProbes,
+	   stats.maxMiss);
+
+    if (stats.compares >= 0)
+	printf("%ld compare calls\n", stats.compares);
+
+    printf("elements by probes to find:");
+
+    for (i = 1; i < SET_HISTOGRAM; i ++)
+	if (stats.histogram[i] > 0)
+	    printf(" %d%s=%d", i, i == SET_HISTOGRAM - 1 ? "+" : "",
+		   stats.histogram[i]);
+
+    printf("\n");
+}
+
+
+/*
+ * Function:    selectProbe
+ *
+ * Description: Select the probe sequence MODE for the set, and return
+ *              false if a different one has already been selected, since
+ *              only one can be used.
+ */
+
+static bool selectProbe(int *probe, int mode)
+{
+    if (*probe != 0 && *probe != mode)
+	return false;
+
+    *probe = mode;
+    return true;
+}
+
+
 /*
  * Function:    main
  *
@@ -34,46 +110,67 @@
 
 int main(int argc, char *argv[])
 {
-    FILE *fp;
-    char buffer[BUFSIZ], **elts;
+    WORDS *wp1, *wp2;
+    char *word, *snapshot = NULL;
     SET *unique;
-    int i, words;
-    bool lflag = false;
+    int i, words, length, mode = 0, probe = SET_LINEAR;
+    bool lflag = false, sflag = false, ok = true;
 
 
     /* Check usage and open the first file. */
 
-    if (argc > 1 && strcmp(argv[1], "-l") == 0) {
-	lflag = true;
+    while (argc > 1 && argv[1][0] == '-') {
+	if (strcmp(argv[1], "-l") == 0)
+	    lflag = true;
+	else if (strcmp(argv[1], "-r") == 0)
+	    ok = selectProbe(&probe, SET_ROBIN_HOOD) && ok;
+	else if (strcmp(argv[1], "-q") == 0)
+	    ok = selectProbe(&probe, SET_QUADRATIC) && ok;
+	else if (strcmp(argv[1], "-d") == 0)
+	    ok = selectProbe(&probe, SET_DOUBLE) && ok;
+	else if (strcmp(argv[1], "-b") == 0)
+	    mode |= SET_BLOOM;
+	else if (strcmp(argv[1], "-i") == 0)
+	    mode |= SET_INLINE;
+	else if (strcmp(argv[1], "-s") == 0)
+	    sflag = true;
+	else if (strcmp(argv[1], "-w") == 0 && argc > 2) {
+	    snapshot = argv[2];
+	    argc --;
+
+	    for (i = 1; i < argc; i ++)
+		argv[i] = argv[i + 1];
+	} else
+	    break;
+
 	argc --;
 
 	for (i = 1; i < argc; i ++)
 	    argv[i] = argv[i + 1];
     }
 
-    if (argc == 1 || argc > 3) {
-        fprintf(stderr, "usage: %s [-l] file1 [file2]\n", argv[0]);
+    if (argc == 1 || argc > 3 || !ok) {
+        fprintf(stderr, "usage: %s [-l] [-r | -q | -d] [-b] [-i] [-s] [-w snapshot] file1 [file2]\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
-    if ((fp = fopen(argv[1], "r")) == NULL) {
+    if ((wp1 = openWords(argv[1])) == NULL) {
         fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
         exit(EXIT_FAILURE);
     }
 
 
-    /* Insert all words into the set. */
+    /* Insert all words into the set.  Each word is given to the set as a
+       temporary string, and the set copies only the distinct ones. */
 
     words = 0;
-    unique = createSet(MAX_SIZE);
+    unique = createSetWith(MAX_SIZE, mode | probe);
 
-    while (fscanf(fp, "%s", buffer) == 1) {
+    while ((word = nextWord(wp1, &length)) != NULL) {
         words ++;
-        addElement(unique, buffer);
+        addElement(unique, termWord(wp1, word, length));
     }
 
-    fclose(fp);
-
     if (!lflag) {
 	printf("%d total words\n", words);
 	printf("%d distinct words\n", numElements(unique));
@@ -83,7 +180,7 @@ int main(int argc, char *argv[])
     /* Try to open the second file. */
 
     if (argc == 3) {
-        if ((fp = fopen(argv[2], "r")) == NULL) {
+        if ((wp2 = openWords(argv[2])) == NULL) {
             fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[2]);
             exit(EXIT_FAILURE);
         }
@@ -91,27 +188,33 @@ int main(int argc, char *argv[])
 
         /* Delete all words in the second file. */
 
-        while (fscanf(fp, "%s", buffer) == 1)
-            removeElement(unique, buffer);
+        while ((word = nextWord(wp2, &length)) != NULL)
+            removeElement(unique, termWord(wp2, word, length));
 
-	fclose(fp);
+	closeWords(wp2);
 
 	if (!lflag)
 	    printf("%d remaining words\n", numElements(unique));
     }
 
 
-    /* Print the list of words if desired. */
+    /* Print the list of words straight from the set if desired. */
+
+    if (lflag)
+	forEachElement(unique, printElement, stdout);
+
+    if (sflag)
+	printStats(unique);
 
-    if (lflag) {
-	elts = getElements(unique);
 
-	for (i = 0; i < numElements(unique); i ++)
-	    printf("%s\n", elts[i]);
+    /* Write the set to a snapshot if desired. */
 
-	free(elts);
+    if (snapshot != NULL && !saveSet(unique, snapshot)) {
+	fprintf(stderr, "%s: cannot write %s\n", argv[0], snapshot);
+	exit(EXIT_FAILURE);
     }
 
     destroySet(unique);
+    closeWords(wp1);
     exit(EXIT_SUCCESS);
 }
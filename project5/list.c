@@ -2,6 +2,12 @@
 #include <stdlib.h>
 #include <assert.h>
 
+#ifdef SET_STATS
+#define COMPARE(lp, x, y) ((lp)->compares++, (*(lp)->compare)((x), (y)))
+#else
+#define COMPARE(lp, x, y) ((*(lp)->compare)((x), (y)))
+#endif
+
 typedef struct node
 {
 	struct node *prev;
@@ -14,6 +20,9 @@ typedef struct list
 	int count;
 	int (*compare)();
 	NODE *head;
+#ifdef SET_STATS
+	long compares;
+#endif
 } LIST;
 
 LIST *createList(int(*compare)());
@@ -28,6 +37,8 @@ void *getLast(LIST *lp);
 void removeItem(LIST *lp, void *item);
 void *findItem(LIST *lp, void *item);
 void *getItems(LIST *lp);
+void *nextItem(LIST *lp, void **pos);
+long numCompares(LIST *lp);
 
 // Allocates memory to the list and to the dummy node, which will simplify the cases for list operations
 // O(1)
@@ -38,6 +49,9 @@ LIST *createList(int(*compare)())
 	assert(lp!=NULL);
 	lp->count=0;
 	lp->compare=compare;
+#ifdef SET_STATS
+	lp->compares=0;
+#endif
 	lp->head=malloc(sizeof(NODE));
 	assert(lp->head!=NULL);
 	lp->head->next=lp->head;
@@ -151,7 +165,7 @@ void removeItem(LIST *lp, void* item)
 	NODE *p=lp->head->next;
 	while(p!=lp->head)
 	{
-		if((*lp->compare)(p->data, item)==0)
+		if(COMPARE(lp, p->data, item)==0)
 		{
 			p->prev->next=p->next;
 			p->next->prev=p->prev;
@@ -172,7 +186,7 @@ void *findItem(LIST *lp, void *item)
 	NODE *p=lp->head->next;
 	while(p!=lp->head)
 	{
-		if((*lp->compare)(p->data,item)==0)
+		if(COMPARE(lp, p->data, item)==0)
 			return p->data;
 		p=p->next;
 	}
@@ -184,7 +198,7 @@ void *findItem(LIST *lp, void *item)
 // O(n)
 void *getItems(LIST *lp)
 {
-	void **temp=malloc(sizeof(NODE)*lp->count);
+	void **temp=malloc(sizeof(void *)*lp->count);
 	assert(temp!=NULL);
 	NODE *p=lp->head->next;
 	int i=0;
@@ -196,3 +210,27 @@ void *getItems(LIST *lp)
 	}	
 	return temp;
 }
+
+// Returns the item after the node that *pos points to and moves *pos to its node, or returns NULL once the end of the list pointed to by lp is reached; If *pos is NULL, it returns the first item instead. The node is opaque to the interface, so the list can be walked in place without copying its items, as long as it is not changed along the way
+// O(1)
+void *nextItem(LIST *lp, void **pos)
+{
+	assert(lp!=NULL && pos!=NULL);
+	NODE *p=(*pos==NULL) ? lp->head->next : ((NODE *)*pos)->next;
+	if(p==lp->head)
+		return NULL;
+	*pos=p;
+	return p->data;
+}
+
+// Returns the number of calls to the compare function made by the list pointed to by lp, which are only counted if it is compiled with SET_STATS defined, or -1 if they are not
+// O(1)
+long numCompares(LIST *lp)
+{
+	assert(lp!=NULL);
+#ifdef SET_STATS
+	return lp->compares;
+#else
+	return -1;
+#endif
+}
@@ -39,4 +39,8 @@ extern void *findItem(LIST *lp, void *item);
 
 extern void *getItems(LIST *lp);
 
+extern void *nextItem(LIST *lp, void **pos);
+
+extern long numCompares(LIST *lp);
+
 # endif /* LIST_H */
@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 #define AVG_CHAIN_LENGTH 20
 
 struct set
@@ -100,31 +101,94 @@ void *findElement(SET *sp, void *elt)
 		return findItem(sp->lists[idx],elt);
 }
 
-// Allocates memory to a pointer to an array of void elements; It then uses a buffer array, items, to get the data from each individual list; Finally, the data is copied from the buffer array into the array that contains all of the elements in the set; This process is repeated until all of the lists in the set pointed to by sp are traversed
-// O(n^3)
+// Allocates memory to a pointer to an array of void elements; It then walks each list in the set pointed to by sp in place with nextItem, copying the data of each node straight into the array, so no buffer array is allocated per list
+// O(n)
 void *getElements(SET *sp)
 {
 	assert(sp!=NULL);
 	void **temp=malloc(sizeof(void *)*sp->count);
-	void **items;
-	int i, j;
-	int count;
+	assert(temp!=NULL);
 	int tempCounter=0;
-	for(i=0;i<sp->length;i++)
+	CURSOR c;
+	void *elt;
+	beginElements(sp, &c);
+	while((elt=nextElement(sp, &c))!=NULL)
 	{
-		count=numItems(sp->lists[i]);
-		items=malloc(sizeof(void *)*count);
-		items=getItems(sp->lists[i]);
-		for(j=0;j<count;j++)
-		{
-			temp[tempCounter]=items[j];
-			tempCounter++;
-		}
-		
-	}	
+		temp[tempCounter]=elt;
+		tempCounter++;
+	}
 	return temp;
 }
 
+// Starts a traversal of the set with the cursor pointed to by cp, which the caller allocates; The cursor holds the index of the list being walked and the last node visited in it, so nothing is allocated or copied
+// O(1)
+void beginElements(SET *sp, CURSOR *cp)
+{
+	assert(sp!=NULL && cp!=NULL);
+	cp->index=0;
+	cp->node=NULL;
+}
+
+// Returns the next element of the traversal with the cursor pointed to by cp, or NULL once every list has been walked; It moves on to the next list whenever the current one runs out. The elements are visited in the same order as getElements, and the set must not be changed during the traversal
+// O(1) amortized
+void *nextElement(SET *sp, CURSOR *cp)
+{
+	assert(sp!=NULL && cp!=NULL);
+	void *elt;
+	while(cp->index<sp->length)
+	{
+		elt=nextItem(sp->lists[cp->index], &cp->node);
+		if(elt!=NULL)
+			return elt;
+		cp->index++;
+		cp->node=NULL;
+	}
+	return NULL;
+}
+
+// Calls (*visit)(elt, arg) on each element of the set in the order of nextElement, so that the caller can stream the elements without an array of them
+// O(n)
+void forEachElement(SET *sp, void (*visit)(), void *arg)
+{
+	assert(sp!=NULL && visit!=NULL);
+	CURSOR c;
+	void *elt;
+	beginElements(sp, &c);
+	while((elt=nextElement(sp, &c))!=NULL)
+		(*visit)(elt, arg);
+}
+
+// Fills in the statistics pointed to by stats by walking every chain in place. An element is found after one probe for each node up to and including its own, and a miss probes the whole chain, so the probes to miss are averaged over the chains. The compare calls are the sum of those made by the lists
+// O(n)
+void getSetStats(SET *sp, STATS *stats)
+{
+	assert(sp!=NULL && stats!=NULL);
+	int i, n;
+	void *pos;
+	memset(stats, 0, sizeof(STATS));
+	stats->count=sp->count;
+	stats->length=sp->length;
+	stats->load=(double)sp->count/sp->length;
+	for(i=0;i<sp->length;i++)
+	{
+		n=0;
+		pos=NULL;
+		while(nextItem(sp->lists[i], &pos)!=NULL)
+			stats->hitProbes+=++n;
+		stats->missProbes+=n;
+		if(n>stats->maxMiss)
+			stats->maxMiss=n;
+		stats->histogram[n<SET_HISTOGRAM ? n : SET_HISTOGRAM-1]++;
+		stats->compares+=numCompares(sp->lists[i]);
+	}
+	if(sp->length>0 && numCompares(sp->lists[0])==-1)
+		stats->compares=-1;
+	stats->maxHit=stats->maxMiss;
+	stats->missProbes/=sp->length;
+	if(sp->count>0)
+		stats->hitProbes/=sp->count;
+}
+
 // Private search function that searches for an element pointed to by elt; It locates the list to traverse through using the hashing function; Finally, it returns the proper index for insertion, deletion, etc and changes the boolean for the result of the search
 // O(n^2) 
 static int search(SET *sp, void *elt, bool *found)
@@ -14,6 +14,33 @@
 
 typedef struct set SET;
 
+typedef struct cursor {
+    int index;			/* chain being visited */
+    void *node;			/* last node visited in the chain */
+} CURSOR;
+
+/* The statistics returned by getSetStats.  A probe is one node of a
+   chain, so a miss probes every node of its chain.  Entry i of the
+   histogram counts the chains of length i, and the last entry also counts
+   any longer chains.  The calls to the compare function are only counted
+   if the set and list are compiled with SET_STATS defined, as in
+   make CFLAGS="-g -Wall -DSET_STATS". */
+
+# define SET_HISTOGRAM	16
+
+typedef struct stats {
+    int count;			/* number of elements */
+    int length;			/* number of chains */
+    int deleted;		/* number of tombstones, always zero */
+    double load;		/* elements per chain */
+    double hitProbes;		/* average probes to find an element */
+    double missProbes;		/* average probes to miss */
+    int maxHit;			/* most probes to find an element */
+    int maxMiss;		/* most probes to miss */
+    int histogram[SET_HISTOGRAM];	/* chains by length */
+    long compares;		/* compare calls, or -1 if not counted */
+} STATS;
+
 SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)());
 
 void destroySet(SET *sp);
@@ -28,4 +55,12 @@ void *findElement(SET *sp, void *elt);
 
 void *getElements(SET *sp);
 
+void beginElements(SET *sp, CURSOR *cp);
+
+void *nextElement(SET *sp, CURSOR *cp);
+
+void forEachElement(SET *sp, void (*visit)(), void *arg);
+
+void getSetStats(SET *sp, STATS *stats);
+
 # endif /* SET_H */
@@ -11,7 +11,9 @@
  *              are inserted into the set and the counts of total words and
  *              total words in the set are printed.  If the second file is
  *              given then all words in the second file are deleted from
- *              the set and the count printed.
+ *              the set and the count printed.  The -l option prints the
+ *              words left in the set instead of the counts, and the -s
+ *              option prints the chain lengths of the set at the end.
  */
 
 # include <stdio.h>
@@ -44,6 +46,54 @@ static unsigned strhash(char *s)
 }
 
 
+/*
+ * Function:    printElement
+ *
+ * Description: Print an element of the set on a line of its own.
+ */
+
+static void printElement(char *elt, FILE *fp)
+{
+    fprintf(fp, "%s\n", elt);
+}
+
+
+/*
+ * Function:    printStats
+ *
+ * Description: Print the statistics of a set, as given by getSetStats.
+ */
+
+static void printStats(SET *sp)
+{
+    STATS stats;
+    int i;
+
+
+    getSetStats(sp, &stats);
+    printf("%d elements in %d chains, load %.3f\n", stats.count, stats.length,
+	   stats.load);
+    printf("%d tombstones, ratio %.3f\n", stats.deleted,
+	   (double) stats.deleted / stats.length);
+    printf("probes to find: average %.3f, most %d\n", stats.hitProbes,
+	   stats.maxHit);
+    printf("probes to miss: average %.3f, most %d\n", stats.missProbes,
+	   stats.maxMiss);
+
+    if (stats.compares >= 0)
+	printf("%ld compare calls\n", stats.compares);
+
+    printf("chains by length:");
+
+    for (i = 0; i < SET_HISTOGRAM; i ++)
+	if (stats.histogram[i] > 0)
+	    printf(" %d%s=%d", i, i == SET_HISTOGRAM - 1 ? "+" : "",
+		   stats.histogram[i]);
+
+    printf("\n");
+}
+
+
 /*
  * Function:    main
  *
@@ -53,16 +103,22 @@ static unsigned strhash(char *s)
 int main(int argc, char *argv[])
 {
     FILE *fp;
-    char buffer[BUFSIZ], **elts, *word;
+    char buffer[BUFSIZ], *word;
     SET *unique;
     int i, words;
-    bool lflag = false;
+    bool lflag = false, sflag = false;
 
 
     /* Check usage and open the first file. */
 
-    if (argc > 1 && strcmp(argv[1], "-l") == 0) {
-	lflag = true;
+    while (argc > 1 && argv[1][0] == '-') {
+	if (strcmp(argv[1], "-l") == 0)
+	    lflag = true;
+	else if (strcmp(argv[1], "-s") == 0)
+	    sflag = true;
+	else
+	    break;
+
 	argc --;
 
 	for (i = 1; i < argc; i ++)
@@ -70,7 +126,7 @@ int main(int argc, char *argv[])
     }
 
     if (argc == 1 || argc > 3) {
-        fprintf(stderr, "usage: %s [-l] file1 [file2]\n", argv[0]);
+        fprintf(stderr, "usage: %s [-l] [-s] file1 [file2]\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
@@ -124,16 +180,13 @@ int main(int argc, char *argv[])
     }
 
 
-    /* Print the list of words if desired. */
-
-    if (lflag) {
-	elts = getElements(unique);
+    /* Print the list of words straight from the set if desired. */
 
-	for (i = 0; i < numElements(unique); i ++)
-	    printf("%s\n", elts[i]);
+    if (lflag)
+	forEachElement(unique, printElement, stdout);
 
-	free(elts);
-    }
+    if (sflag)
+	printStats(unique);
 
     destroySet(unique);
     exit(EXIT_SUCCESS);
@@ -97,3 +97,11 @@ void *removeEntry(PQ *pq)
 	pq->count--;
 	return pDel;
 }
+
+// Returns the smallest entry in the priority queue without removing it, which is always at the root of the min heap
+// O(1)
+void *firstEntry(PQ *pq)
+{
+	assert(pq!=NULL && pq->count>0);
+	return pq->data[0];
+}
@@ -23,4 +23,6 @@ void addEntry(PQ *pq, void *entry);
 
 void *removeEntry(PQ *pq);
 
+void *firstEntry(PQ *pq);
+
 # endif /* PQUEUE_H */
@@ -13,9 +13,7 @@
 # include <stdlib.h>
 # include <string.h>
 # include "list.h"
-
-
-# define MAX_WORD_LENGTH 30		/* maximum length of a single word */
+# include "words.h"
 
 
 /*
@@ -86,9 +84,10 @@ static void quickSort(LIST *lp, int lo, int hi)
 
 int main(int argc, char *argv[])
 {
-    FILE *fp;
+    WORDS *wp;
     LIST *words;
-    char word[MAX_WORD_LENGTH+1];
+    char *word;
+    int length;
 
 
     /* Check the number of arguments and try to open the file. */
@@ -98,22 +97,21 @@ int main(int argc, char *argv[])
 	exit(EXIT_FAILURE);
     }
 
-    fp = fopen(argv[1], "r");
+    wp = openWords(argv[1]);
 
-    if (fp == NULL) {
+    if (wp == NULL) {
 	fprintf(stderr, "cannot open file\n");
 	exit(EXIT_FAILURE);
     }
 
 
-    /* Read each word into the buffer and add it to the list. */
+    /* Add a copy of each word of the mapped file to the list.  The copies
+       last as long as the tokenizer. */
 
     words = createList();
 
-    while (fscanf(fp, "%s", word) == 1)
-	addLast(words, strdup(word));
-
-    fclose(fp);
+    while ((word = nextWord(wp, &length)) != NULL)
+	addLast(words, keepWord(wp, word, length));
 
 
     /* Sort the words in the list and print them out in sorted order. */
@@ -124,5 +122,6 @@ int main(int argc, char *argv[])
 	printf("%s\n", (char *) removeFirst(words));
 
     destroyList(words);
+    closeWords(wp);
     exit(EXIT_SUCCESS);
 }
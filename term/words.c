@@ -0,0 +1,186 @@
+#include <assert.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "words.h"
+
+#define READ_SIZE 65536
+#define CHUNK_SIZE 65536
+
+struct chunk
+{
+	struct chunk *next;
+	char data[];
+};
+
+struct words
+{
+	char *base;
+	size_t size;
+	size_t pos;
+	bool mapped;
+	char *temp;
+	int tempSize;
+	struct chunk *chunks;
+	char *avail;
+	size_t left;
+};
+
+static char *readAll(int fd, size_t *size);
+
+
+// Opens the file with the given path and maps it into memory, or returns NULL if it cannot be opened. The mapping is read-only, so the pages of the file are shared with the page cache and never copied; words are returned as views into it, and only the words that a caller needs as null-terminated strings are copied, by termWord and keepWord. A file that cannot be mapped, such as a pipe, is read into memory instead
+// O(1) to map, O(n) to read
+WORDS *openWords(char *path)
+{
+	int fd;
+	struct stat st;
+	WORDS *wp;
+	assert(path!=NULL);
+	if((fd=open(path, O_RDONLY))<0)
+		return NULL;
+	wp=malloc(sizeof(WORDS));
+	assert(wp!=NULL);
+	wp->base=NULL;
+	wp->size=0;
+	wp->pos=0;
+	wp->mapped=false;
+	wp->temp=NULL;
+	wp->tempSize=0;
+	wp->chunks=NULL;
+	wp->avail=NULL;
+	wp->left=0;
+	if(fstat(fd, &st)==0 && S_ISREG(st.st_mode))
+	{
+		wp->size=st.st_size;
+		if(wp->size==0)
+			wp->mapped=true;
+		else
+		{
+			wp->base=mmap(NULL, wp->size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if(wp->base!=MAP_FAILED)
+			{
+				wp->mapped=true;
+				madvise(wp->base, wp->size, MADV_SEQUENTIAL);
+			}
+		}
+	}
+	if(wp->mapped==false)
+		wp->base=readAll(fd, &wp->size);
+	close(fd);
+	return wp;
+}
+
+// Frees up the memory of the tokenizer, including the copies made by keepWord, and unmaps the file, after which none of the words that it returned may be used
+// O(m) for the m chunks of copies
+void closeWords(WORDS *wp)
+{
+	assert(wp!=NULL);
+	struct chunk *cp;
+	if(wp->mapped==true && wp->size>0)
+		munmap(wp->base, wp->size);
+	else if(wp->mapped==false)
+		free(wp->base);
+	while((cp=wp->chunks)!=NULL)
+	{
+		wp->chunks=cp->next;
+		free(cp);
+	}
+	free(wp->temp);
+	free(wp);
+}
+
+// Returns a pointer to the next word of the file and sets *length to its length, or returns NULL once there are no more words. The word is a view into the file and is not null-terminated, since the mapping is read-only; it stays valid until the tokenizer is closed
+// O(n)
+char *nextWord(WORDS *wp, int *length)
+{
+	assert(wp!=NULL && length!=NULL);
+	char *base=wp->base;
+	size_t start, end=wp->pos, size=wp->size;
+	while(end<size && isspace((unsigned char)base[end]))
+		end++;
+	if(end>=size)
+	{
+		wp->pos=size;
+		return NULL;
+	}
+	start=end;
+	while(end<size && !isspace((unsigned char)base[end]))
+		end++;
+	*length=end-start;
+	wp->pos=end;
+	return base+start;
+}
+
+// Copies the word with the given length into a buffer of the tokenizer and returns it as a null-terminated string, for a caller that only needs the string until its next call, such as to look it up in a set; The buffer is reused by each call and doubles in size when a word does not fit
+// O(n)
+char *termWord(WORDS *wp, char *word, int length)
+{
+	assert(wp!=NULL && word!=NULL && length>=0);
+	if(length>=wp->tempSize)
+	{
+		wp->tempSize=wp->tempSize==0 ? BUFSIZ : wp->tempSize;
+		while(length>=wp->tempSize)
+			wp->tempSize*=2;
+		free(wp->temp);
+		wp->temp=malloc(wp->tempSize);
+		assert(wp->temp!=NULL);
+	}
+	memcpy(wp->temp, word, length);
+	wp->temp[length]='\0';
+	return wp->temp;
+}
+
+// Copies the word with the given length and returns it as a null-terminated string that stays valid until the tokenizer is closed, for a caller that keeps the word, such as in a set that does not copy its elements; The copies are packed into chunks of CHUNK_SIZE bytes that are all freed by closeWords, so no copy is allocated or freed on its own
+// O(n)
+char *keepWord(WORDS *wp, char *word, int length)
+{
+	assert(wp!=NULL && word!=NULL && length>=0);
+	char *copy;
+	struct chunk *cp;
+	size_t size;
+	if(wp->left<(size_t)length+1)
+	{
+		size=(size_t)length+1>CHUNK_SIZE ? (size_t)length+1 : CHUNK_SIZE;
+		cp=malloc(sizeof(struct chunk)+size);
+		assert(cp!=NULL);
+		cp->next=wp->chunks;
+		wp->chunks=cp;
+		wp->avail=cp->data;
+		wp->left=size;
+	}
+	copy=wp->avail;
+	memcpy(copy, word, length);
+	copy[length]='\0';
+	wp->avail+=length+1;
+	wp->left-=length+1;
+	return copy;
+}
+
+// Reads the rest of the file open on fd into a new buffer, and sets *size to the number of bytes read
+// O(n)
+static char *readAll(int fd, size_t *size)
+{
+	size_t length=READ_SIZE, used=0;
+	ssize_t n;
+	char *buffer=malloc(length);
+	assert(buffer!=NULL);
+	while((n=read(fd, buffer+used, length-used))>0)
+	{
+		used+=n;
+		if(used==length)
+		{
+			length*=2;
+			buffer=realloc(buffer, length);
+			assert(buffer!=NULL);
+		}
+	}
+	*size=used;
+	return buffer;
+}